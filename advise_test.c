@@ -0,0 +1,109 @@
+// compile with: gcc -o advise_test advise_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_advise_disk.img"
+
+static char expected[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+
+// reads the whole file through a stream; returns 1 if the contents match
+int read_all_matches(const char* filename, int* window_at_open, int* window_at_end) {
+    fs_read_stream* stream;
+    const void* chunk;
+    if (fs_read_stream_open(filename, &stream) != 0) {
+        return 0;
+    }
+    *window_at_open = fs_read_stream_window(stream);
+    int total = 0, got, matches = 1;
+    while ((got = fs_read_stream_next(stream, &chunk)) > 0) {
+        matches = matches && memcmp(chunk, expected + total, got) == 0;
+        total += got;
+    }
+    *window_at_end = fs_read_stream_window(stream);
+    fs_read_stream_close(stream);
+    return matches && got == 0 && total == (int)sizeof(expected);
+}
+
+int main() {
+    int window_at_open, window_at_end;
+
+    printf("=== Testing access hints ===\n");
+
+    for (int i = 0; i < (int)sizeof(expected); i++) {
+        expected[i] = (char)(i % 233);
+    }
+
+    // Test 1: parameter validation
+    printf("Test 1 - Parameter validation: ");
+    int unmounted = fs_advise("file.bin", FS_ADVICE_NORMAL);
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("file.bin");
+    fs_write("file.bin", expected, sizeof(expected));
+    if (unmounted == -3 && fs_advise("missing", FS_ADVICE_NORMAL) == -1 && fs_advise(NULL, FS_ADVICE_NORMAL) == -3 &&
+        fs_advise("file.bin", -1) == -3 && fs_advise("file.bin", FS_ADVICE_DONTNEED + 1) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: sequential and random hints pin the read-ahead window
+    printf("Test 2 - Sequential and random hints: ");
+    int sequential_ok = fs_advise("file.bin", FS_ADVICE_SEQUENTIAL) == 0 &&
+                        read_all_matches("file.bin", &window_at_open, &window_at_end) &&
+                        window_at_open == MAX_DIRECT_BLOCKS && window_at_end == MAX_DIRECT_BLOCKS;
+    int random_ok = fs_advise("file.bin", FS_ADVICE_RANDOM) == 0 &&
+                    read_all_matches("file.bin", &window_at_open, &window_at_end) &&
+                    window_at_open == 1 && window_at_end == 1;
+    if (sequential_ok && random_ok) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - sequential %d, random %d\n", sequential_ok, random_ok);
+        return 1;
+    }
+
+    // Test 3: one-shot hints keep the stored pattern and the data intact
+    printf("Test 3 - Willneed and dontneed: ");
+    int hints_ok = fs_advise("file.bin", FS_ADVICE_WILLNEED) == 0 && fs_advise("file.bin", FS_ADVICE_DONTNEED) == 0 &&
+                   read_all_matches("file.bin", &window_at_open, &window_at_end) && window_at_open == 1;
+    int normal_ok = fs_advise("file.bin", FS_ADVICE_NORMAL) == 0 &&
+                    read_all_matches("file.bin", &window_at_open, &window_at_end) &&
+                    window_at_open < window_at_end && window_at_end == MAX_DIRECT_BLOCKS;
+    if (hints_ok && normal_ok) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - hints %d, normal %d\n", hints_ok, normal_ok);
+        return 1;
+    }
+
+    // Test 4: hints do not survive a delete or a remount
+    printf("Test 4 - Hints are dropped with the file and at mount: ");
+    fs_advise("file.bin", FS_ADVICE_RANDOM);
+    fs_delete("file.bin");
+    fs_create("file.bin");
+    fs_write("file.bin", expected, sizeof(expected));
+    int recreated_ok = read_all_matches("file.bin", &window_at_open, &window_at_end) && window_at_end == MAX_DIRECT_BLOCKS;
+    fs_advise("file.bin", FS_ADVICE_RANDOM);
+    fs_unmount();
+    fs_mount(TEST_DISK);
+    int remounted_ok = read_all_matches("file.bin", &window_at_open, &window_at_end) && window_at_end == MAX_DIRECT_BLOCKS;
+    if (recreated_ok && remounted_ok) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - recreated %d, remounted %d\n", recreated_ok, remounted_ok);
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
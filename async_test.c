@@ -0,0 +1,119 @@
+// compile with: gcc -o async_test async_test.c fs.c fs_async.c -Wall -Wextra -pthread
+
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include "fs_ext.h"
+#include "fs_async.h"
+
+#define TEST_DISK "test_async_disk.img"
+#define FILE_COUNT 32
+
+static int callbacks_seen = 0; // only touched by the single worker of test 3
+
+void count_completion(fs_async_request* request) {
+    if (request->result == 0) {
+        callbacks_seen++;
+    }
+}
+
+int main() {
+    fs_async_request requests[FILE_COUNT];
+    fs_async_request* completed[FILE_COUNT];
+    char names[FILE_COUNT][16];
+    char buffers[FILE_COUNT][16];
+
+    printf("=== Testing asynchronous operations ===\n");
+
+    // Test 1: the pool must be running and requests must be valid
+    printf("Test 1 - Invalid use rejected: ");
+    if (fs_async_create(&requests[0], "a", NULL, NULL) == -3 && fs_async_start(0, -1) == -3 &&
+        fs_async_start(FS_ASYNC_MAX_WORKERS + 1, -1) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    int event_fd = eventfd(0, 0);
+
+    // Test 2: many creates in flight, completions counted by the eventfd and reaped
+    printf("Test 2 - Creates through the completion queue: ");
+    fs_async_start(4, event_fd);
+    for (int i = 0; i < FILE_COUNT; i++) {
+        snprintf(names[i], sizeof(names[i]), "file%d", i);
+        fs_async_create(&requests[i], names[i], NULL, NULL);
+    }
+    uint64_t signalled = 0;
+    int reaped = 0;
+    while (signalled < FILE_COUNT) {
+        uint64_t count;
+        if (read(event_fd, &count, sizeof(count)) == sizeof(count)) {
+            signalled += count; // a request is queued before its completion is signalled
+        }
+        reaped += fs_async_reap(completed + reaped, FILE_COUNT - reaped);
+    }
+    int all_created = 1;
+    for (int i = 0; i < FILE_COUNT; i++) {
+        all_created &= completed[i]->result == 0;
+    }
+    if (all_created && reaped == FILE_COUNT && signalled == FILE_COUNT && fs_exists(names[FILE_COUNT - 1]) == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+    fs_async_stop();
+
+    // Test 3: writes report through callbacks, then reads see the data
+    printf("Test 3 - Writes with callbacks, then reads: ");
+    fs_async_start(1, -1);
+    for (int i = 0; i < FILE_COUNT; i++) {
+        fs_async_write(&requests[i], names[i], names[i], strlen(names[i]) + 1, count_completion, NULL);
+    }
+    fs_async_drain();
+    for (int i = 0; i < FILE_COUNT; i++) {
+        fs_async_read(&requests[i], names[i], buffers[i], sizeof(buffers[i]), NULL, NULL);
+    }
+    fs_async_drain();
+    int reads_ok = fs_async_reap(completed, FILE_COUNT) == FILE_COUNT;
+    for (int i = 0; i < FILE_COUNT; i++) {
+        reads_ok &= requests[i].result == (int)strlen(names[i]) + 1 && strcmp(buffers[i], names[i]) == 0;
+    }
+    if (callbacks_seen == FILE_COUNT && reads_ok) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - %d callbacks\n", callbacks_seen);
+        return 1;
+    }
+
+    // Test 4: errors come back as the fs_* result, stop completes queued work
+    printf("Test 4 - Errors and stop: ");
+    fs_async_delete(&requests[0], "missing", NULL, NULL);
+    fs_async_delete(&requests[1], names[1], NULL, NULL);
+    fs_async_stop();
+    fs_async_lock();
+    int deleted = fs_exists(names[1]) == 0;
+    fs_async_unlock();
+    if (requests[0].result == -1 && requests[1].result == 0 && deleted &&
+        fs_async_delete(&requests[2], names[2], NULL, NULL) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    close(event_fd);
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
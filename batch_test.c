@@ -0,0 +1,90 @@
+// compile with: gcc -o batch_test batch_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_batch_disk.img"
+
+// Helper to read one inode straight from the on-disk inode table
+int read_inode_on_disk(const char* path, int inode_index, inode* out) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    lseek(fd, 2 * BLOCK_SIZE + inode_index * sizeof(inode), SEEK_SET);
+    int result = (read(fd, out, sizeof(inode)) == sizeof(inode)) ? 0 : -1;
+    close(fd);
+    return result;
+}
+
+int main() {
+    const char* names[] = {"one", "two", "three", "two", ""};
+    int results[5];
+    fs_file_stat stats[5];
+    inode on_disk;
+
+    printf("=== Testing batched metadata calls ===\n");
+
+    // Test 1: not mounted
+    printf("Test 1 - Not mounted: ");
+    if (fs_create_many(names, 3, NULL) == -3 && fs_delete_many(names, 3, NULL) == -3 &&
+        fs_stat_many(names, 3, stats, NULL) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+
+    // Test 2: per-name results and a single write-back of the table
+    printf("Test 2 - Create many: ");
+    int created = fs_create_many(names, 5, results);
+    if (created == 3 && results[0] == 0 && results[1] == 0 && results[2] == 0 && results[3] == -1 &&
+        results[4] == -3 && read_inode_on_disk(TEST_DISK, 2, &on_disk) == 0 && on_disk.used == 1 &&
+        strcmp(on_disk.name, "three") == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - created %d\n", created);
+        return 1;
+    }
+
+    // Test 3: stat many
+    printf("Test 3 - Stat many: ");
+    fs_write("two", "abc", 3);
+    const char* stat_names[] = {"one", "two", "missing"};
+    if (fs_stat_many(stat_names, 3, stats, results) == 2 && stats[0].size == 0 && stats[1].size == 3 &&
+        results[2] == -1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: delete many frees blocks and inodes and reaches the disk
+    printf("Test 4 - Delete many: ");
+    fs_statfs_info before, after;
+    fs_statfs(&before);
+    const char* delete_names[] = {"two", "missing", "three"};
+    if (fs_delete_many(delete_names, 3, results) == 2 && results[1] == -1 && fs_statfs(&after) == 0 &&
+        after.free_blocks == before.free_blocks + 1 && after.free_inodes == before.free_inodes + 2 &&
+        fs_exists("one") == 1 && fs_exists("two") == 0 &&
+        read_inode_on_disk(TEST_DISK, 1, &on_disk) == 0 && on_disk.used == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+// compile with: gcc -c fs.c fs_async.c && g++ -std=c++20 -o coro_test coro_test.cpp fs.o fs_async.o -pthread
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include "fs_coro.hpp"
+
+#define TEST_DISK "test_coro_disk.img"
+
+using onlyfiles::task;
+
+task<int> write_then_read(const char* name, const char* text, char* out, int out_size) {
+    int created = co_await onlyfiles::async_create(name);
+    if (created != 0) {
+        co_return created;
+    }
+    int written = co_await onlyfiles::async_write(name, text, static_cast<int>(std::strlen(text)) + 1);
+    if (written != 0) {
+        co_return written;
+    }
+    co_return co_await onlyfiles::async_read(name, out, out_size);
+}
+
+task<int> copy_pair(char (*outs)[32]) {
+    // nested tasks resume their caller when they finish
+    int first = co_await write_then_read("left", "left side", outs[0], 32);
+    int second = co_await write_then_read("right", "right side", outs[1], 32);
+    co_return first + second;
+}
+
+task<> delete_both(int* results) {
+    results[0] = co_await onlyfiles::async_delete("left");
+    results[1] = co_await onlyfiles::async_delete("missing");
+}
+
+int main() {
+    std::printf("=== Testing coroutine layer ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_async_start(2, -1);
+
+    // Test 1: a single awaited chain returns the fs_read result
+    std::printf("Test 1 - Awaited create, write, read: ");
+    char buffer[32] = {0};
+    task<int> single = write_then_read("one", "hello", buffer, sizeof(buffer));
+    single.start();
+    if (single.get() == 6 && std::strcmp(buffer, "hello") == 0) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: many tasks in flight at once, plus nesting
+    std::printf("Test 2 - Concurrent and nested tasks: ");
+    char outs[2][32] = {};
+    char names[16][16];
+    char reads[16][32] = {};
+    task<int> nested = copy_pair(outs);
+    nested.start();
+    bool all_ok = true;
+    {
+        std::optional<task<int>> tasks[16];
+        for (int i = 0; i < 16; i++) {
+            std::snprintf(names[i], sizeof(names[i]), "f%d", i);
+            tasks[i].emplace(write_then_read(names[i], names[i], reads[i], 32));
+            tasks[i]->start();
+        }
+        for (int i = 0; i < 16; i++) {
+            all_ok = all_ok && tasks[i]->get() == static_cast<int>(std::strlen(names[i])) + 1 &&
+                     std::strcmp(reads[i], names[i]) == 0;
+        }
+    }
+    if (all_ok && nested.get() == 21 && std::strcmp(outs[1], "right side") == 0) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: errors surface as the fs_* return value
+    std::printf("Test 3 - Error results: ");
+    int results[2] = {1, 1};
+    task<> deleting = delete_both(results);
+    deleting.start();
+    deleting.get();
+    if (results[0] == 0 && results[1] == -1) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: without a running pool the await completes at once with -3
+    std::printf("Test 4 - Pool stopped: ");
+    fs_async_stop();
+    task<int> orphan = write_then_read("late", "x", buffer, sizeof(buffer));
+    orphan.start();
+    if (orphan.get() == -3) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    std::printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+// compile with: gcc -c fs.c && g++ -std=c++20 -o cpp_wrapper_test cpp_wrapper_test.cpp fs.o
+
+#include <cstdio>
+#include <cstring>
+#include <ranges>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "fs.hpp"
+
+#define TEST_DISK "test_cpp_wrapper_disk.img"
+
+static_assert(std::input_iterator<onlyfiles::listing::iterator>);
+static_assert(std::ranges::input_range<onlyfiles::listing>);
+
+int main() {
+    std::printf("=== Testing C++ wrapper ===\n");
+
+    onlyfiles::filesystem::format(TEST_DISK);
+
+    // Test 1: the mount follows the object, including moves
+    std::printf("Test 1 - RAII mount: ");
+    {
+        onlyfiles::filesystem scoped(TEST_DISK);
+        onlyfiles::filesystem moved(std::move(scoped));
+        if (!moved || scoped.is_mounted() || moved.create("scoped.txt") != 0) {
+            std::printf("FAILED\n");
+            return 1;
+        }
+    }
+    onlyfiles::filesystem fs(TEST_DISK); // fails unless the scope above unmounted
+    if (fs && fs.open("scoped.txt").exists() == 1) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: span and string_view reads and writes
+    std::printf("Test 2 - Span I/O: ");
+    std::string_view long_name = "name-that-is-far-too-long-for-the-filesystem";
+    std::vector<std::byte> payload(5000, std::byte{0x5A});
+    std::vector<std::byte> readback(payload.size());
+    char text[16] = {};
+    onlyfiles::file notes = fs.open("notes");
+    if (fs.create(notes.name()) == 0 && notes.write("hello") == 0 && notes.read(std::span<char>(text)) == 5 &&
+        std::strcmp(text, "hello") == 0 && fs.create("blob") == 0 && fs.write("blob", payload) == 0 &&
+        fs.read("blob", readback) == 5000 && readback == payload && fs.create(long_name) == -3) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: listings page through more entries than one page holds
+    std::printf("Test 3 - Listing ranges: ");
+    for (int i = 0; i < 70; i++) {
+        fs.create("bulk" + std::to_string(i));
+    }
+    int all = 0, bulk = 0;
+    long total_size = 0;
+    for (const onlyfiles::dir_entry& entry : fs.list()) {
+        all++;
+        total_size += entry.size;
+    }
+    std::string previous;
+    bool ordered = true;
+    for (const auto& entry : fs.list_prefix("bulk")) {
+        ordered = ordered && std::string(entry.name) > previous;
+        previous = entry.name;
+        bulk++;
+    }
+    if (all == 73 && bulk == 70 && ordered && total_size == 5005) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED - %d files, %d bulk\n", all, bulk);
+        return 1;
+    }
+
+    // Test 4: directory listings
+    std::printf("Test 4 - Directory listing: ");
+    fs.mkdir("docs");
+    fs.create("docs/a");
+    fs.create("docs/b");
+    int children = 0;
+    for (const auto& entry : fs.list_dir("docs")) {
+        children += entry.name.starts_with("docs/");
+    }
+    int empty = 0;
+    for ([[maybe_unused]] const auto& entry : fs.list_prefix("zzz")) {
+        empty++;
+    }
+    if (children == 2 && empty == 0) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    fs.unmount();
+
+    std::printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
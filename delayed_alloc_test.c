@@ -0,0 +1,190 @@
+// compile with: gcc -o delayed_alloc_test delayed_alloc_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_delayed_disk.img"
+
+// Helper to count used data blocks in the on-disk bitmap
+int count_used_data_blocks_on_disk(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    unsigned char bitmap[BLOCK_SIZE];
+    lseek(fd, BLOCK_SIZE, SEEK_SET);
+    if (read(fd, bitmap, BLOCK_SIZE) != BLOCK_SIZE) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    int used = 0;
+    for (int block_index = 10; block_index < MAX_BLOCKS; block_index++) {
+        if (bitmap[block_index / 8] & (1 << (block_index % 8))) used++;
+    }
+    return used;
+}
+
+int main() {
+    char data[3 * BLOCK_SIZE];
+    char buffer[3 * BLOCK_SIZE];
+    char name[MAX_FILENAME];
+
+    printf("=== Testing FS_POLICY_DELAYED_ALLOCATION ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_set_write_policy(FS_POLICY_DELAYED_ALLOCATION);
+
+    // Test 1: staged data is readable but has no blocks yet
+    printf("Test 1 - Write is staged in memory: ");
+    memset(data, 'D', sizeof(data));
+    fs_create("staged.txt");
+    if (fs_write("staged.txt", data, sizeof(data)) == 0 &&
+        fs_read("staged.txt", buffer, sizeof(buffer)) == (int)sizeof(buffer) &&
+        memcmp(buffer, data, sizeof(data)) == 0 && count_used_data_blocks_on_disk(TEST_DISK) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: a temp file deleted before flush never touches the disk
+    printf("Test 2 - Deleted temp file never allocates: ");
+    fs_create("temp.txt");
+    fs_write("temp.txt", data, sizeof(data));
+    fs_delete("temp.txt");
+    fs_sync();
+    if (count_used_data_blocks_on_disk(TEST_DISK) == 3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - expected only staged.txt blocks on disk\n");
+        return 1;
+    }
+
+    // Test 3: reservations are enforced before any block is allocated
+    printf("Test 3 - Out of space reported by fs_write: ");
+    char big[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+    memset(big, 'B', sizeof(big));
+    int result = 0;
+    int files_written = 0;
+    for (int i = 0; i < MAX_FILES - 1 && result == 0; i++) {
+        snprintf(name, sizeof(name), "big_%d", i);
+        fs_create(name);
+        result = fs_write(name, big, sizeof(big));
+        if (result == 0) files_written++;
+    }
+    // 2547 free blocks hold 212 files of 12 blocks
+    if (result == -2 && files_written == (MAX_BLOCKS - 10 - 3) / MAX_DIRECT_BLOCKS) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - result %d after %d files\n", result, files_written);
+        return 1;
+    }
+
+    // Test 4: everything staged survives unmount
+    printf("Test 4 - Data flushed on unmount: ");
+    fs_unmount();
+    fs_set_write_policy(FS_POLICY_IN_PLACE);
+    fs_mount(TEST_DISK);
+    snprintf(name, sizeof(name), "big_%d", files_written - 1);
+    if (fs_read(name, big, sizeof(big)) == (int)sizeof(big) && big[sizeof(big) - 1] == 'B' &&
+        fs_read("staged.txt", buffer, sizeof(buffer)) == (int)sizeof(buffer) &&
+        memcmp(buffer, data, sizeof(data)) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+    fs_unmount();
+
+    // Test 5: rewriting files in place only reserves the blocks they do not have yet
+    printf("Test 5 - In-place rewrites reserve only new blocks: ");
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    for (int i = 0; i < 16; i++) {
+        snprintf(name, sizeof(name), "rewrite_%d", i);
+        fs_create(name);
+        fs_write(name, big, sizeof(big));
+    }
+    fs_statfs_info info;
+    fs_statfs(&info);
+    for (int i = 0; info.free_blocks > 100; i++) {
+        int blocks = info.free_blocks - 100;
+        blocks = (blocks < MAX_DIRECT_BLOCKS) ? blocks : MAX_DIRECT_BLOCKS;
+        snprintf(name, sizeof(name), "fill_%d", i);
+        fs_create(name);
+        fs_write(name, big, blocks * BLOCK_SIZE);
+        fs_statfs(&info);
+    }
+    fs_set_write_policy(FS_POLICY_DELAYED_ALLOCATION);
+    memset(big, 'R', sizeof(big));
+    int rewrites_ok = 1;
+    for (int i = 0; i < 16; i++) {
+        snprintf(name, sizeof(name), "rewrite_%d", i);
+        rewrites_ok = rewrites_ok && fs_write(name, big, sizeof(big)) == 0;
+    }
+    fs_statfs(&info);
+    int staged_ok = info.reserved_blocks == 0 && info.available_blocks == 100;
+    fs_set_write_policy(FS_POLICY_IN_PLACE);
+    fs_statfs(&info);
+    memset(big, 0, sizeof(big));
+    if (rewrites_ok && staged_ok && info.free_blocks == 100 && fs_read("rewrite_15", big, sizeof(big)) == (int)sizeof(big) &&
+        big[0] == 'R' && big[sizeof(big) - 1] == 'R') {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - rewrites %d, staged accounting %d, free %d\n", rewrites_ok, staged_ok, info.free_blocks);
+        return 1;
+    }
+    fs_unmount();
+
+    // Test 6: a flush that cannot write its data keeps the staged copy and the old blocks
+    printf("Test 6 - Failed flush keeps staged data: ");
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("log.bin");
+    fs_write("log.bin", "old contents", 12);
+    fs_set_write_policy(FS_POLICY_LOG_STRUCTURED | FS_POLICY_DELAYED_ALLOCATION);
+    fs_write("log.bin", "new contents", 12);
+    fs_statfs_info before;
+    fs_statfs(&before);
+    // data block writes past the metadata now fail with EFBIG
+    struct rlimit saved_limit, metadata_only;
+    getrlimit(RLIMIT_FSIZE, &saved_limit);
+    metadata_only = saved_limit;
+    metadata_only.rlim_cur = 10 * BLOCK_SIZE; // the soft limit only, so it can be raised again
+    signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &metadata_only);
+    int failed_sync = fs_sync();
+    setrlimit(RLIMIT_FSIZE, &saved_limit);
+    fs_statfs(&info);
+    char contents[16] = {0};
+    int kept = failed_sync == -3 && info.free_blocks == before.free_blocks && info.reserved_blocks == before.reserved_blocks &&
+               count_used_data_blocks_on_disk(TEST_DISK) == 1 && fs_read("log.bin", contents, sizeof(contents)) == 12 &&
+               memcmp(contents, "new contents", 12) == 0;
+    int retried = fs_sync() == 0;
+    fs_unmount();
+    fs_mount(TEST_DISK);
+    memset(contents, 0, sizeof(contents));
+    if (kept && retried && fs_read("log.bin", contents, sizeof(contents)) == 12 && memcmp(contents, "new contents", 12) == 0 &&
+        count_used_data_blocks_on_disk(TEST_DISK) == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - kept %d, retried %d\n", kept, retried);
+        return 1;
+    }
+    fs_set_write_policy(FS_POLICY_IN_PLACE);
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
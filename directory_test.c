@@ -0,0 +1,91 @@
+// compile with: gcc -o directory_test directory_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_directory_disk.img"
+
+// Helper to count the direct children of a directory, checking for a given entry
+int count_children(const char* path, const char* expected_name, int* found) {
+    fs_list_cursor cursor = FS_LIST_CURSOR_INIT;
+    fs_dirent page[2];
+    int total = 0;
+    int count;
+    *found = 0;
+    while ((count = fs_list_dir(path, &cursor, page, 2)) > 0) {
+        for (int i = 0; i < count; i++) {
+            if (expected_name && strcmp(page[i].name, expected_name) == 0) *found = 1;
+        }
+        total += count;
+    }
+    return (count < 0) ? -1 : total;
+}
+
+int main() {
+    char name[MAX_FILENAME];
+    int found;
+
+    printf("=== Testing directories ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+
+    // Test 1: mkdir validation
+    printf("Test 1 - mkdir rules: ");
+    if (fs_mkdir("logs") == 0 && fs_mkdir("logs") == -1 && fs_mkdir("missing/child") == -3 &&
+        fs_mkdir("/abs") == -3 && fs_mkdir("trail/") == -3 && fs_mkdir("") == -3 &&
+        fs_mkdir("logs/2024") == 0 && fs_exists("logs/2024/") == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: listing returns direct children only
+    printf("Test 2 - Direct children: ");
+    for (int i = 0; i < 5; i++) {
+        snprintf(name, sizeof(name), "logs/app%d.log", i);
+        fs_create(name);
+        snprintf(name, sizeof(name), "logs/2024/day%d.log", i);
+        fs_create(name);
+    }
+    fs_create("top.txt");
+    int logs_children = count_children("logs", "logs/2024/", &found);
+    int found_subdir = found;
+    int nested_children = count_children("logs/2024", "logs/2024/day3.log", &found);
+    int found_nested = found;
+    int top_children = count_children("", "logs/", &found);
+    if (logs_children == 6 && found_subdir && nested_children == 5 && found_nested &&
+        top_children == 2 && found) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - %d %d %d\n", logs_children, nested_children, top_children);
+        return 1;
+    }
+
+    // Test 3: rmdir only removes empty directories
+    printf("Test 3 - rmdir: ");
+    int not_empty = fs_rmdir("logs/2024");
+    for (int i = 0; i < 5; i++) {
+        snprintf(name, sizeof(name), "logs/2024/day%d.log", i);
+        fs_delete(name);
+    }
+    if (not_empty == -2 && fs_rmdir("logs/2024") == 0 && fs_rmdir("logs/2024") == -1 &&
+        count_children("logs", NULL, &found) == 5) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+// compile with: gcc -c fs.c && g++ -std=c++20 -o engine_test engine_test.cpp fs.o
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include "fs_engine.hpp"
+
+#define TEST_DISK "test_engine_disk.img"
+#define SMALL_DISK "test_engine_small_disk.img"
+
+using onlyfiles::default_geometry;
+using onlyfiles::engine;
+
+// a small-block tenant: 512-byte blocks, 2 MB image, 64 inodes, 8 pointers
+using small_geometry = onlyfiles::geometry<512, 4096, 64, 8>;
+
+int main() {
+    std::printf("=== Testing the geometry-specialized engine ===\n");
+
+    // Test 1: a small-geometry image formats, mounts and serves files
+    std::printf("Test 1 - Small geometry: ");
+    engine<small_geometry>::format(SMALL_DISK);
+    {
+        engine<small_geometry> small(SMALL_DISK);
+        std::string contents(1300, 'x'); // three 512-byte blocks
+        contents[1299] = 'y';
+        char buffer[small_geometry::max_file_size];
+        if (small.is_mounted() && small.create("notes") == 0 && small.write("notes", contents) == 0 &&
+            small.read("notes", std::span(buffer)) == 1300 && std::memcmp(buffer, contents.data(), 1300) == 0 &&
+            small.free_blocks() == static_cast<int>(small_geometry::data_blocks) - 3) {
+            std::printf("PASSED\n");
+        } else {
+            std::printf("FAILED\n");
+            return 1;
+        }
+    }
+
+    // Test 2: files and counters survive a remount, including a record that straddles two blocks
+    std::printf("Test 2 - Remount: ");
+    {
+        engine<small_geometry> small(SMALL_DISK);
+        char name[16];
+        for (int i = 1; i <= 7; i++) {
+            std::snprintf(name, sizeof(name), "s%d", i);
+            small.create(name);
+        }
+        small.write("s7", "straddle");
+    }
+    {
+        engine<small_geometry> small(SMALL_DISK);
+        char buffer[16];
+        if (small.read("s7", std::span(buffer)) == 8 && std::memcmp(buffer, "straddle", 8) == 0 &&
+            small.free_inodes() == 64 - 8 && small.free_blocks() == static_cast<int>(small_geometry::data_blocks) - 4) {
+            std::printf("PASSED\n");
+        } else {
+            std::printf("FAILED\n");
+            return 1;
+        }
+    }
+
+    // Test 3: the return codes of fs.h, and rewrites that shrink and grow in place
+    std::printf("Test 3 - Error codes: ");
+    {
+        engine<small_geometry> small(SMALL_DISK);
+        char big[small_geometry::max_file_size + 1] = {0};
+        char buffer[16];
+        bool codes = small.create("notes") == -1 && small.remove("missing") == -1 &&
+                     small.write("missing", "data") == -1 && small.read("missing", std::span(buffer)) == -1 &&
+                     small.write("notes", std::as_bytes(std::span(big))) == -2 && small.create("") == -3 &&
+                     small.mount(SMALL_DISK) == -1;
+        int before = small.free_blocks();
+        bool shrink = small.write("notes", "short") == 0 && small.free_blocks() == before + 2;
+        bool regrow = small.write("notes", std::string_view(big, 1024)) == 0 && small.free_blocks() == before + 1;
+        bool removed = small.remove("notes") == 0 && small.exists("notes") == 0 && small.free_blocks() == before + 3;
+        if (codes && shrink && regrow && removed) {
+            std::printf("PASSED\n");
+        } else {
+            std::printf("FAILED\n");
+            return 1;
+        }
+    }
+
+    // Test 4: the default geometry mounts an image written by fs.c
+    std::printf("Test 4 - Reads fs.c images: ");
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("from_c");
+    std::string large(3 * BLOCK_SIZE + 100, 'c');
+    fs_write("from_c", large.data(), static_cast<int>(large.size()));
+    fs_unmount();
+    {
+        engine<default_geometry> image(TEST_DISK);
+        static char buffer[default_geometry::max_file_size];
+        if (image.read("from_c", std::span(buffer)) == static_cast<int>(large.size()) &&
+            std::memcmp(buffer, large.data(), large.size()) == 0 && image.free_inodes() == MAX_FILES - 1) {
+            std::printf("PASSED\n");
+        } else {
+            std::printf("FAILED\n");
+            return 1;
+        }
+        image.create("from_engine");
+        image.write("from_engine", "written by the engine");
+        image.remove("from_c");
+    }
+
+    // Test 5: fs.c mounts what the engine wrote
+    std::printf("Test 5 - fs.c reads engine images: ");
+    char buffer[64] = {0};
+    if (fs_mount(TEST_DISK) == 0 && fs_read("from_engine", buffer, sizeof(buffer)) == 21 &&
+        std::strcmp(buffer, "written by the engine") == 0 && fs_read("from_c", buffer, sizeof(buffer)) == -1) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+    fs_unmount();
+
+    // Test 6: an image of one geometry is refused by an engine of another
+    std::printf("Test 6 - Geometry mismatch: ");
+    {
+        engine<small_geometry> wrong(TEST_DISK);
+        engine<default_geometry> also_wrong(SMALL_DISK);
+        if (!wrong.is_mounted() && !also_wrong.is_mounted()) {
+            std::printf("PASSED\n");
+        } else {
+            std::printf("FAILED\n");
+            return 1;
+        }
+    }
+
+    // Test 7: a shrinking rewrite leaves zeros past the new end, which fs_truncate exposes when it grows the file
+    std::printf("Test 7 - Zero padded tail: ");
+    {
+        engine<default_geometry> image(TEST_DISK);
+        image.create("f");
+        image.write("f", std::string(8000, 'A'));
+        image.write("f", "BBBB");
+    }
+    static char grown[BLOCK_SIZE];
+    static const char zeros[BLOCK_SIZE] = {0};
+    fs_mount(TEST_DISK);
+    if (fs_truncate("f", BLOCK_SIZE) == 0 && fs_read("f", grown, sizeof(grown)) == BLOCK_SIZE &&
+        std::memcmp(grown, "BBBB", 4) == 0 && std::memcmp(grown + 4, zeros, BLOCK_SIZE - 4) == 0) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+    fs_unmount();
+
+    unlink(TEST_DISK);
+    unlink(SMALL_DISK);
+    std::printf("All engine tests passed!\n");
+    return 0;
+}
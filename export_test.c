@@ -0,0 +1,111 @@
+// compile with: gcc -o export_test export_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <fcntl.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_export_disk.img"
+#define TEST_OUTPUT "test_export_output.bin"
+
+static char expected[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+static char collected[MAX_DIRECT_BLOCKS * BLOCK_SIZE + 16];
+
+// reads back everything the test wrote to the output file
+int read_output(void) {
+    int fd = open(TEST_OUTPUT, O_RDONLY);
+    int total = 0, got;
+    while ((got = read(fd, collected + total, sizeof(collected) - total)) > 0) {
+        total += got;
+    }
+    close(fd);
+    return total;
+}
+
+int main() {
+    printf("=== Testing export to host descriptors ===\n");
+
+    for (int i = 0; i < (int)sizeof(expected); i++) {
+        expected[i] = (char)(i % 241);
+    }
+    int size = 5 * BLOCK_SIZE + 321;
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("data.bin");
+    fs_write("data.bin", expected, size);
+
+    // Test 1: parameter validation
+    printf("Test 1 - Parameter validation: ");
+    if (fs_export_to_fd("missing", 1) == -1 && fs_export_to_fd(NULL, 1) == -3 && fs_export_to_fd("data.bin", -1) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: export to a regular file continues at its offset
+    printf("Test 2 - Export to a regular file: ");
+    int out_fd = open(TEST_OUTPUT, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    write(out_fd, "header", 6);
+    int exported = fs_export_to_fd("data.bin", out_fd);
+    close(out_fd);
+    int total = read_output();
+    if (exported == size && total == 6 + size && memcmp(collected, "header", 6) == 0 &&
+        memcmp(collected + 6, expected, size) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - exported %d, file holds %d\n", exported, total);
+        return 1;
+    }
+
+    // Test 3: export into a pipe, with a hole in the middle
+    printf("Test 3 - Export to a pipe with a hole: ");
+    fs_truncate("data.bin", BLOCK_SIZE);
+    fs_truncate("data.bin", 3 * BLOCK_SIZE);
+    int pipe_fds[2];
+    pipe(pipe_fds);
+    exported = fs_export_to_fd("data.bin", pipe_fds[1]);
+    close(pipe_fds[1]);
+    total = 0;
+    int got;
+    while ((got = read(pipe_fds[0], collected + total, sizeof(collected) - total)) > 0) {
+        total += got;
+    }
+    close(pipe_fds[0]);
+    char zeros[2 * BLOCK_SIZE] = {0};
+    if (exported == 3 * BLOCK_SIZE && total == exported && memcmp(collected, expected, BLOCK_SIZE) == 0 &&
+        memcmp(collected + BLOCK_SIZE, zeros, sizeof(zeros)) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - exported %d, read %d\n", exported, total);
+        return 1;
+    }
+
+    // Test 4: staged data is flushed before the kernel copies the image
+    printf("Test 4 - Staged data is exported: ");
+    fs_set_write_policy(FS_POLICY_DELAYED_ALLOCATION);
+    fs_write("data.bin", expected + 100, 2 * BLOCK_SIZE);
+    out_fd = open(TEST_OUTPUT, O_RDWR | O_TRUNC);
+    exported = fs_export_to_fd("data.bin", out_fd);
+    close(out_fd);
+    fs_set_write_policy(FS_POLICY_IN_PLACE);
+    total = read_output();
+    if (exported == 2 * BLOCK_SIZE && total == exported && memcmp(collected, expected + 100, total) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - exported %d\n", exported);
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+    unlink(TEST_OUTPUT);
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+// compile with: gcc -o fallocate_test fallocate_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_fallocate_disk.img"
+
+// Helper to count used data blocks in the on-disk bitmap
+int count_used_data_blocks_on_disk(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    unsigned char bitmap[BLOCK_SIZE];
+    lseek(fd, BLOCK_SIZE, SEEK_SET);
+    if (read(fd, bitmap, BLOCK_SIZE) != BLOCK_SIZE) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    int used = 0;
+    for (int block_index = 10; block_index < MAX_BLOCKS; block_index++) {
+        if (bitmap[block_index / 8] & (1 << (block_index % 8))) used++;
+    }
+    return used;
+}
+
+int main() {
+    char data[5 * BLOCK_SIZE];
+    char buffer[5 * BLOCK_SIZE];
+
+    printf("=== Testing fs_fallocate ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("ingest.bin");
+
+    // Test 1: invalid parameters
+    printf("Test 1 - Error codes: ");
+    if (fs_fallocate("missing.bin", BLOCK_SIZE, 0) == -1 &&
+        fs_fallocate("ingest.bin", MAX_DIRECT_BLOCKS * BLOCK_SIZE + 1, 0) == -2 &&
+        fs_fallocate("ingest.bin", BLOCK_SIZE, 0x40) == -3 &&
+        fs_fallocate("ingest.bin", 0, 0) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: keep-size preallocation reserves blocks but no data
+    printf("Test 2 - Keep-size preallocation: ");
+    if (fs_fallocate("ingest.bin", sizeof(data), FS_FALLOC_KEEP_SIZE) == 0 &&
+        count_used_data_blocks_on_disk(TEST_DISK) == 5 &&
+        fs_read("ingest.bin", buffer, sizeof(buffer)) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: writes inside the preallocated range never allocate
+    printf("Test 3 - Writes reuse preallocated blocks: ");
+    memset(data, 'X', sizeof(data));
+    fs_write("ingest.bin", data, 3 * BLOCK_SIZE);
+    int after_small_write = count_used_data_blocks_on_disk(TEST_DISK);
+    fs_write("ingest.bin", data, sizeof(data));
+    if (after_small_write == 5 && count_used_data_blocks_on_disk(TEST_DISK) == 5 &&
+        fs_read("ingest.bin", buffer, sizeof(buffer)) == (int)sizeof(buffer) &&
+        memcmp(buffer, data, sizeof(data)) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: delete releases the whole reservation
+    printf("Test 4 - Delete frees preallocated blocks: ");
+    fs_delete("ingest.bin");
+    if (count_used_data_blocks_on_disk(TEST_DISK) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 5: growing preallocation reads back zeros even on recycled blocks
+    printf("Test 5 - Size-extending preallocation reads zeros: ");
+    fs_create("zeros.bin");
+    char zeros[2 * BLOCK_SIZE] = {0};
+    if (fs_fallocate("zeros.bin", sizeof(zeros), 0) == 0 &&
+        fs_read("zeros.bin", buffer, sizeof(buffer)) == (int)sizeof(zeros) &&
+        memcmp(buffer, zeros, sizeof(zeros)) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 6: a size-extending preallocation survives shorter rewrites, so chunked growth stays in one extent
+    printf("Test 6 - Size-extending preallocation kept across rewrites: ");
+    static char chunks[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+    memset(chunks, 'G', sizeof(chunks));
+    fs_create("grow.bin");
+    fs_fallocate("grow.bin", sizeof(chunks), 0);
+    fs_write("grow.bin", chunks, BLOCK_SIZE);
+    fs_create("other.bin");
+    fs_write("other.bin", "other", 5); // would take a block the shorter rewrite gave back
+    fs_write("grow.bin", chunks, 2 * BLOCK_SIZE);
+    fs_file_stat grow_stat;
+    if (fs_stat("grow.bin", &grow_stat) == 0 && grow_stat.size == 2 * BLOCK_SIZE &&
+        grow_stat.blocks == MAX_DIRECT_BLOCKS && grow_stat.extents == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 7: fs_truncate ends the preallocation
+    printf("Test 7 - Truncate releases the preallocation: ");
+    fs_truncate("grow.bin", BLOCK_SIZE);
+    fs_write("grow.bin", chunks, BLOCK_SIZE);
+    if (fs_stat("grow.bin", &grow_stat) == 0 && grow_stat.blocks == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+// compile with: gcc -o free_inode_test free_inode_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_free_inode_disk.img"
+
+int main() {
+    char files[MAX_FILES][MAX_FILENAME];
+    char name[32];
+
+    printf("=== Testing free inode allocation ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("a");
+    fs_create("b");
+    fs_create("c");
+    fs_create("d");
+
+    // Test 1: a create reuses the most recently freed inode (fs_list walks inode order)
+    printf("Test 1 - Recently freed inode reused: ");
+    fs_delete("b");
+    fs_delete("c");
+    fs_create("e"); // takes c's inode
+    fs_create("f"); // takes b's inode
+    if (fs_list(files, MAX_FILES) == 4 && strcmp(files[0], "a") == 0 && strcmp(files[1], "f") == 0 &&
+        strcmp(files[2], "e") == 0 && strcmp(files[3], "d") == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: every inode can be handed out exactly once
+    printf("Test 2 - Table fills and reports full: ");
+    int created = 4;
+    for (int i = 0; i < MAX_FILES; i++) {
+        snprintf(name, sizeof(name), "fill%d", i);
+        if (fs_create(name) == 0) {
+            created++;
+        }
+    }
+    fs_statfs_info info;
+    if (created == MAX_FILES && fs_create("overflow") == -2 && fs_statfs(&info) == 0 && info.free_inodes == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - created %d\n", created);
+        return 1;
+    }
+
+    // Test 3: the stack is rebuilt from the inode table on mount
+    printf("Test 3 - Free inodes after remount: ");
+    fs_delete("fill10");
+    fs_delete("fill20");
+    fs_unmount();
+    fs_mount(TEST_DISK);
+    if (fs_statfs(&info) == 0 && info.free_inodes == 2 && fs_create("x") == 0 && fs_create("y") == 0 &&
+        fs_create("z") == -2) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -1,19 +1,143 @@
+#define _GNU_SOURCE // copy_file_range
 #include "fs.h"
+#include "fs_ext.h"
+#include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+#include <fnmatch.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// blocks 0-9 hold the superblock, the bitmap and the inode table
+#define FIRST_DATA_BLOCK 10
+// blocks 2-9 hold the inode table
+#define INODE_TABLE_BLOCK 2
+#define INODE_TABLE_BLOCKS 8
+// open addressing table of the name index - a power of two, twice MAX_FILES so probe chains stay short
+#define NAME_INDEX_SLOTS 512
+// names are cached in zero-padded slots of this size so one slot is one vector compare
+#define NAME_SLOT_SIZE 32
+// counting Bloom filter over live names: 4096 counters and 4 probes give ~0.25% false
+// positives with all 256 inodes in use
+#define NAME_FILTER_COUNTERS 4096
+#define NAME_FILTER_PROBES 4
+// how many files FS_POLICY_DELAYED_ALLOCATION can hold back before the oldest is flushed
+#define DELAYED_WRITE_SLOTS 16
+// blocks a read stream pulls in with one device read
+#define READ_STREAM_BUFFER_BLOCKS 4
+// read-ahead window of a read stream, in blocks; it doubles on sequential refills and halves on seeks
+#define READ_AHEAD_MIN_BLOCKS 1
+#define READ_AHEAD_INITIAL_BLOCKS 2
+#define READ_AHEAD_MAX_BLOCKS MAX_DIRECT_BLOCKS
+
+// data of one fs_write that has not been given physical blocks yet
+typedef struct {
+    int used;             // 1 while the slot holds staged data
+    int inode_index;      // owner of the staged data
+    int size;             // size of the staged file contents in bytes
+    int blocks_needed;    // blocks the staged contents occupy once flushed
+    int reserved_blocks;  // blocks the flush will newly allocate, counted against free_blocks
+    char* data;           // the staged file contents (heap, size bytes)
+} delayed_write;
+
+// one recorded operation of a transaction
+typedef struct {
+    char name[MAX_FILENAME + 1];
+    int is_delete;  // 1 to delete the file, 0 to write data to it
+    int size;       // bytes of data for a write
+    char* data;     // copy of the data for a write (heap)
+} transaction_operation;
+
+struct fs_transaction {
+    transaction_operation* operations; // heap array, grown by doubling
+    int count;
+    int capacity;
+};
+
+// a file being rewritten chunk by chunk, invisible to readers until closed
+struct fs_write_stream {
+    char name[MAX_FILENAME + 1];
+    int blocks[MAX_DIRECT_BLOCKS]; // blocks written so far, owned by the stream until close
+    int blocks_written;
+    int size;                      // bytes accepted so far
+    int buffered;                  // bytes waiting in block_buffer
+    int detached;                  // set when fs_unmount released the blocks under the stream
+    struct fs_write_stream* next_open;
+    char block_buffer[BLOCK_SIZE];
+};
+
+// a chunked read of a file, pinned to the inode contents it was opened on
+struct fs_read_stream {
+    int inode_index;
+    unsigned int generation;       // inode_generations value at open, any change ends the stream
+    int size;
+    int blocks[MAX_DIRECT_BLOCKS];
+    int position;                  // bytes already handed out
+    int buffer_first_block;        // file block held at the start of buffer, -1 when empty
+    int buffer_blocks;             // file blocks held in buffer
+    int readahead_blocks;          // current read-ahead window
+    int prefetched_until;          // file blocks below this have already been advised to the kernel
+    int access_pattern;            // fs_advise pattern of the file at open
+    int drop_behind;               // evict each buffered run from the page cache once it is consumed
+    char buffer[READ_STREAM_BUFFER_BLOCKS * BLOCK_SIZE];
+};
 
 // global vars
 static int disk_file_descriptor = -1;
 static superblock current_superblock = {0}; // hold the superblock data in cache in memory
+// the inode table, loaded at mount and written back per block, split into one array per field
+// so name and used-flag scans do not drag sizes and block maps through the cache
+static unsigned char inode_used_bitmap[MAX_FILES / 8];
+static char inode_names[MAX_FILES][NAME_SLOT_SIZE] __attribute__((aligned(NAME_SLOT_SIZE)));
+static int inode_sizes[MAX_FILES];
+static int inode_block_maps[MAX_FILES][MAX_DIRECT_BLOCKS];
+// free inodes as a LIFO stack, so a create reuses the most recently deleted (cache-warm) inode
+static short free_inode_stack[MAX_FILES];
+static short free_inode_stack_position[MAX_FILES]; // slot of each inode in the stack, -1 while used
+static int free_inode_count = 0;
+static unsigned int inode_table_dirty_blocks = 0; // bit per inode table block not yet written back
+static int metadata_flush_deferred = 0; // > 0 while a batch or a transaction collects its changes for one flush
+static short name_index_slots[NAME_INDEX_SLOTS]; // name hash -> inode index + 1, 0 marks an empty slot
+static unsigned char name_filter_counters[NAME_FILTER_COUNTERS]; // saturate at 255 and then never decrement
+static fs_lookup_stats name_lookup_stats = {0};
+static short sorted_name_index[MAX_FILES]; // inode indices of used inodes, ordered by name
+static int sorted_name_count = 0;
+static unsigned int inode_generations[MAX_FILES]; // last value of generation_clock that touched each inode
+static unsigned int generation_clock = 0; // ticks on every inode modification, memory only
+static unsigned char block_bitmap_cache[BLOCK_SIZE]; // copy of block 1, loaded at mount
+static int bitmap_cache_dirty = 0; // set when block_bitmap_cache differs from the disk
+static int write_policy_flags = FS_POLICY_IN_PLACE;
+static unsigned char inode_access_patterns[MAX_FILES]; // FS_ADVICE_NORMAL, _SEQUENTIAL or _RANDOM given by fs_advise
+static unsigned char inode_drop_behind[MAX_FILES]; // set by FS_ADVICE_DONTNEED, read streams evict what they pass
+static unsigned char inode_preallocated_blocks[MAX_FILES]; // leading blocks fs_fallocate covered, kept by in-place rewrites
+static int log_head_block = FIRST_DATA_BLOCK; // next-fit start for FS_POLICY_LOG_STRUCTURED
+static int free_extents_count = 0; // runs of free data blocks, kept exact by mark_block_as_used/free
+static int largest_free_extent = 0; // cached for fs_statfs, valid while largest_free_extent_valid
+static int largest_free_extent_valid = 0;
+static delayed_write delayed_writes[DELAYED_WRITE_SLOTS] = {{0}};
+static int delayed_reserved_blocks = 0; // sum of reserved_blocks over all staged writes
+static int delayed_eviction_cursor = 0; // round robin victim when every slot is taken
+static fs_write_stream* open_write_streams = NULL; // released by fs_unmount so their blocks do not leak
 
 // #### helper functions declaration #####
 int find_inode_by_name(const char* i_name);
 int find_free_inode();
 void write_inode_to_disk(int inode_index, const inode* i_node);
 int compare_strings(const char* str1, const char* str2);
+int inode_is_used(int inode_index);
+void load_name_slot(char* slot, const char* name);
+int name_slot_equals(const char* slot_a, const char* slot_b);
+void store_inode_in_cache(int inode_index, const inode* i_node);
+void rebuild_free_inode_stack();
+void free_inode_stack_push(int inode_index);
+void free_inode_stack_remove(int inode_index);
 void read_inode_from_disk(int i_inode_index, inode* i_inode_buffer);
 int find_free_block();
 void mark_block_as_used(int block_index);
@@ -21,12 +145,67 @@ void mark_block_as_free(int block_index);
 int validate_block_number_and_filesystem(int i_block_num);
 int read_bitmap_from_disk(unsigned char* i_bitmap_buffer);
 int write_bitmap_to_disk(const unsigned char* i_bitmap_buffer);
+int flush_bitmap_cache();
+int flush_inode_table_cache();
+int flush_metadata_caches();
+int is_data_block_free(int block_index);
+int find_largest_free_extent();
+void recount_free_space();
+//name index helper functions declaration
+unsigned int hash_file_name(const char* name);
+void name_index_insert(int inode_index);
+void name_index_remove(int inode_index);
+void rebuild_name_index();
+void sorted_name_insert(int inode_index);
+void sorted_name_remove(int inode_index);
+unsigned int second_hash_file_name(const char* name);
+void name_filter_update(const char* name, int delta);
+int name_filter_may_contain(const char* name);
+int compare_file_names(const char* name1, const char* name2);
+int sorted_name_lower_bound(const char* name, int strictly_after);
+int list_ordered_range(const char* prefix, const char* pattern, int children_only, fs_list_cursor* cursor, fs_dirent* entries, int max_entries);
+//directory helper functions declaration
+int build_directory_prefix(const char* path, char* prefix_buffer);
+int delete_file_by_inode(int inode_index);
+int release_file_inode(int inode_index);
 //fs_writer helper functions declaration
 int validate_write_operation_parameters(const char* filename, const void* data, int size);
-int check_available_space_for_write_operation(int blocks_needed, int current_file_size);
+int check_available_space_for_write_operation(int blocks_needed, int current_file_blocks);
 int free_file_existing_blocks(inode* file_inode);
+int count_file_allocated_blocks(const inode* file_inode);
+int count_file_allocated_blocks_in_range(const inode* file_inode, int blocks_count);
+int release_blocks_before_rewrite(int inode_index, inode* file_inode, int blocks_needed);
 int allocate_blocks_for_file(inode* file_inode, int blocks_needed);
 int write_data_to_allocated_blocks(inode* file_inode, const void* data, int size, int blocks_needed);
+//delayed allocation helper functions declaration
+int find_free_block_run(int blocks_count);
+int allocate_contiguous_blocks_for_file(inode* file_inode, int blocks_needed);
+int find_delayed_write_slot(int inode_index);
+int stage_delayed_write(int inode_index, int slot_index, const void* data, int size, int blocks_needed);
+int flush_delayed_write(int slot_index);
+int flush_all_delayed_writes();
+void discard_delayed_write(int slot_index);
+//transaction helper functions declaration
+transaction_operation* record_transaction_operation(fs_transaction* transaction, const char* filename);
+int validate_transaction(const fs_transaction* transaction);
+int apply_transaction(const fs_transaction* transaction);
+int transaction_write_block_delta(const char* filename, int size);
+//write stream helper functions declaration
+int write_stream_flush_block(fs_write_stream* stream);
+void write_stream_release(fs_write_stream* stream);
+void detach_open_write_streams();
+//read stream helper functions declaration
+int read_stream_fill(fs_read_stream* stream, int file_block);
+int read_stream_buffered_bytes(fs_read_stream* stream, const char** chunk);
+void read_stream_adjust_window(fs_read_stream* stream, int file_block);
+void read_stream_prefetch(fs_read_stream* stream);
+void read_stream_drop_buffered(fs_read_stream* stream);
+void advise_file_blocks(const int* blocks, int first_block, int end_block, int advice);
+//export helper functions declaration
+int export_image_range(off_t image_offset, int bytes, int out_fd, int* use_sendfile);
+int export_zeros(int bytes, int out_fd);
+//preallocation helper functions declaration
+int zero_file_blocks(const inode* file_inode, int first_block, int blocks_count);
 
 
 int fs_format(const char* disk_path)
@@ -135,6 +314,48 @@ int fs_mount(const char* disk_path)
             disk_file_descriptor = -1;
             return -1; // invalid superblock values - not a valid filesystem
         }
+
+    // keep the bitmap in memory so allocation does not re-read block 1 for every block
+    if(read_bitmap_from_disk(block_bitmap_cache) != 0) {
+        close(disk_file_descriptor);
+        disk_file_descriptor = -1;
+        return -1;
+    }
+    bitmap_cache_dirty = 0;
+
+    // the whole inode table comes in with one read and every name lookup is served from it
+    inode* inode_table = malloc(MAX_FILES * sizeof(inode));
+    lseek(disk_file_descriptor, INODE_TABLE_BLOCK * BLOCK_SIZE, SEEK_SET);
+    if(inode_table == NULL ||
+       read(disk_file_descriptor, inode_table, MAX_FILES * sizeof(inode)) != (ssize_t)(MAX_FILES * sizeof(inode))) {
+        free(inode_table);
+        close(disk_file_descriptor);
+        disk_file_descriptor = -1;
+        return -1;
+    }
+    for(int i = 0; i < MAX_FILES; i++) {
+        store_inode_in_cache(i, &inode_table[i]);
+    }
+    free(inode_table);
+    inode_table_dirty_blocks = 0;
+    memset(inode_access_patterns, FS_ADVICE_NORMAL, sizeof(inode_access_patterns));
+    memset(inode_preallocated_blocks, 0, sizeof(inode_preallocated_blocks));
+    memset(inode_drop_behind, 0, sizeof(inode_drop_behind));
+    rebuild_name_index();
+    rebuild_free_inode_stack();
+
+    // the superblock counters are only written at unmount, so after a crash they can
+    // disagree with the bitmap and the inode table - those two are the truth
+    recount_free_space();
+
+    // continue the log right after the last used block, as if the image was one long log
+    log_head_block = FIRST_DATA_BLOCK;
+    for(int block_index = MAX_BLOCKS - 1; block_index >= FIRST_DATA_BLOCK; block_index--) {
+        if(block_bitmap_cache[block_index / 8] & (1 << (block_index % 8))) {
+            log_head_block = (block_index + 1 < MAX_BLOCKS) ? block_index + 1 : FIRST_DATA_BLOCK;
+            break;
+        }
+    }
     
     // if we reachto this line, we successfully mounted the filesystem
     return 0;
@@ -146,6 +367,15 @@ void fs_unmount()
         return; // not mounted 
     }
 
+    detach_open_write_streams();
+    flush_all_delayed_writes();
+    for(int slot_index = 0; slot_index < DELAYED_WRITE_SLOTS; slot_index++) {
+        if(delayed_writes[slot_index].used) {
+            discard_delayed_write(slot_index); // could not be flushed, nothing else can take it after this
+        }
+    }
+    flush_metadata_caches();
+
     //write the superblock back to disk
     lseek(disk_file_descriptor, 0, SEEK_SET);
     write(disk_file_descriptor, &current_superblock, sizeof(superblock));
@@ -181,6 +411,7 @@ int fs_create(const char* filename)
     new_inode.used = 1; // mark as used
 
     write_inode_to_disk(free_inode_index, &new_inode);
+    flush_metadata_caches();
 
     // update superblock and free inodes count
     current_superblock.free_inodes--;
@@ -195,21 +426,12 @@ int fs_list(char filenames[][MAX_FILENAME], int max_files)
         return -1;
     }
 
-    inode current_inode;
     int num_of_files_found = 0;
 
     for(int i = 0; i < MAX_FILES && num_of_files_found < max_files; i++) {
-        off_t cur_inode_pos = (2 * BLOCK_SIZE) + (i * sizeof(inode));
-        lseek(disk_file_descriptor, cur_inode_pos, SEEK_SET);
-
-        int count_of_reading_buf = read(disk_file_descriptor, &current_inode, sizeof(inode));
-        
-        if(count_of_reading_buf != sizeof(inode)) {
-            return -1; 
-        }
-
-        if(current_inode.used) {
-            strncpy(filenames[num_of_files_found], current_inode.name, MAX_FILENAME);
+        if(inode_is_used(i)) {
+            // the cached slot is zero padded, so the stored part of the name can be copied whole
+            memcpy(filenames[num_of_files_found], inode_names[i], MAX_FILENAME - 1);
             filenames[num_of_files_found][MAX_FILENAME - 1] = '\0'; // ensure null termination
             num_of_files_found++;
         }
@@ -233,29 +455,43 @@ int fs_write(const char* filename, const void* data, int size)
     read_inode_from_disk(inode_index, &current_file_inode);
 
     int blocks_needed = (size + BLOCK_SIZE - 1) / BLOCK_SIZE; 
-    int free_space_check = check_available_space_for_write_operation(blocks_needed, current_file_inode.size);
+    // blocks reserved by a staged write of this same file are ours to reuse
+    int pending_slot = find_delayed_write_slot(inode_index);
+    int pending_reserved_blocks = (pending_slot >= 0) ? delayed_writes[pending_slot].reserved_blocks : 0;
+    int free_space_check = check_available_space_for_write_operation(blocks_needed - pending_reserved_blocks,
+                                                                     count_file_allocated_blocks(&current_file_inode));
     if(free_space_check < 0) {
         return free_space_check; // return the error code
     }
 
-    // free existing blocks if the file is being resized
-    int free_blocks_result = free_file_existing_blocks(&current_file_inode);
+    if(write_policy_flags & FS_POLICY_DELAYED_ALLOCATION) {
+        return stage_delayed_write(inode_index, pending_slot, data, size, blocks_needed);
+    }
+    if(pending_slot >= 0) {
+        discard_delayed_write(pending_slot); // this write supersedes the staged one
+    }
+
+    // release the blocks this write does not keep (all of them in log mode)
+    int free_blocks_result = release_blocks_before_rewrite(inode_index, &current_file_inode, blocks_needed);
     if(free_blocks_result < 0) {
         return free_blocks_result; // return the error code
     }
-    // allocate new blocks for the file
+    // allocate blocks for the parts of the file that have none yet
     int allocate_blocks_result = allocate_blocks_for_file(&current_file_inode, blocks_needed);
     if(allocate_blocks_result < 0) {
+        flush_metadata_caches(); // the old blocks may already be released
         return allocate_blocks_result; 
     }
 
     int write_data_result = write_data_to_allocated_blocks(&current_file_inode, data, size, blocks_needed);
     if(write_data_result < 0) {
+        flush_metadata_caches();
         return write_data_result; 
     }
 
     current_file_inode.size = size;
     write_inode_to_disk(inode_index, &current_file_inode);
+    flush_metadata_caches(); // one inode table and one bitmap write for the whole operation
 
     return 0;
     
@@ -276,6 +512,14 @@ int fs_read(const char* filename, void* buffer, int size)
         return -1; // file not found
     }
 
+    // data that is still staged by delayed allocation is served from memory
+    int pending_slot = find_delayed_write_slot(inode_index);
+    if(pending_slot >= 0) {
+        int staged_bytes = (size < delayed_writes[pending_slot].size) ? size : delayed_writes[pending_slot].size;
+        memcpy(buffer, delayed_writes[pending_slot].data, staged_bytes);
+        return staged_bytes;
+    }
+
     inode current_file_inode;
     read_inode_from_disk(inode_index, &current_file_inode);
     // If requested size is larger than file size, only read available bytes
@@ -291,13 +535,19 @@ int fs_read(const char* filename, void* buffer, int size)
 
     for(int i = 0; i < blocks_to_read; i++) {
         int block_number = current_file_inode.blocks[i];
+        int remaining_bytes = bytes_to_read - total_bytes_read;
+        int bytes_from_this_block = (remaining_bytes > BLOCK_SIZE) ? BLOCK_SIZE : remaining_bytes;
+
+        if(block_number == 0) {
+            // a hole left by fs_truncate - reads as zeros without touching the disk
+            memset(read_buffer + total_bytes_read, 0, bytes_from_this_block);
+            total_bytes_read += bytes_from_this_block;
+            continue;
+        }
 
         if(block_number < 10 || block_number >= MAX_BLOCKS) {
             return -3; // invalid block index
         }
-
-        int remaining_bytes = bytes_to_read - total_bytes_read;
-        int bytes_from_this_block = (remaining_bytes > BLOCK_SIZE) ? BLOCK_SIZE : remaining_bytes;
         //temp buffer for reading all block data
         char temp_block_buffer[BLOCK_SIZE] = {0};
         off_t block_offset = block_number * BLOCK_SIZE;
@@ -333,6 +583,65 @@ int fs_delete(const char* filename)
         return -1; // file not found
     }
 
+    return delete_file_by_inode(inode_index);
+}
+
+int fs_rename(const char* old_name, const char* new_name)
+{
+    if(disk_file_descriptor < 0) {
+        return -3; // not mounted
+    }
+
+    if(old_name == NULL || strlen(old_name) == 0 || strlen(old_name) > MAX_FILENAME ||
+       new_name == NULL || strlen(new_name) == 0 || strlen(new_name) > MAX_FILENAME) {
+        return -3; // invalid parameters
+    }
+
+    int source_index = find_inode_by_name(old_name);
+    if(source_index < 0) {
+        return -1; // file not found
+    }
+
+    // the inode keeps only MAX_FILENAME - 1 characters, so the target is whatever holds that form
+    char stored_new_name[MAX_FILENAME] = {0};
+    strncpy(stored_new_name, new_name, sizeof(stored_new_name) - 1);
+
+    int target_index = find_inode_by_name(stored_new_name);
+    if(target_index == source_index) {
+        return 0; // renaming onto itself changes nothing
+    }
+
+    // only the name of the inode changes - the data blocks stay where they are.
+    // the renamed source reaches the disk before the target is released, so a
+    // crash in between leaves both files behind instead of losing the target
+    inode renamed_inode;
+    read_inode_from_disk(source_index, &renamed_inode);
+    memset(renamed_inode.name, 0, sizeof(renamed_inode.name));
+    memcpy(renamed_inode.name, stored_new_name, sizeof(stored_new_name));
+    write_inode_to_disk(source_index, &renamed_inode);
+    flush_metadata_caches();
+
+    if(target_index >= 0 && delete_file_by_inode(target_index) < 0) {
+        return -3;
+    }
+    return 0;
+}
+
+int delete_file_by_inode(int inode_index)
+{
+    int result = release_file_inode(inode_index);
+    flush_metadata_caches();
+    return result;
+}
+
+int release_file_inode(int inode_index)
+{
+    // staged data of a deleted file never reaches the allocator or the disk
+    int pending_slot = find_delayed_write_slot(inode_index);
+    if(pending_slot >= 0) {
+        discard_delayed_write(pending_slot);
+    }
+
     inode file_inode_to_delete;
     read_inode_from_disk(inode_index, &file_inode_to_delete);
     // free the blocks allocated for the file
@@ -345,238 +654,1958 @@ int fs_delete(const char* filename)
     file_inode_to_delete.used = 0; // mark inode as free
     write_inode_to_disk(inode_index, &file_inode_to_delete);
 
+    // hints belong to the file, not to whoever gets the inode next
+    inode_access_patterns[inode_index] = FS_ADVICE_NORMAL;
+    inode_drop_behind[inode_index] = 0;
+    inode_preallocated_blocks[inode_index] = 0;
+
     current_superblock.free_inodes++;
     return 0; 
 }
 
+int fs_set_write_policy(int policy_flags)
+{
+    if(policy_flags & ~(FS_POLICY_LOG_STRUCTURED | FS_POLICY_DELAYED_ALLOCATION)) {
+        return -3; // unknown policy bits
+    }
+
+    // leaving delayed allocation: staged data must not outlive the policy
+    if(!(policy_flags & FS_POLICY_DELAYED_ALLOCATION) && flush_all_delayed_writes() < 0) {
+        return -3;
+    }
+
+    write_policy_flags = policy_flags;
+    return 0;
+}
 
+int fs_get_write_policy(void)
+{
+    return write_policy_flags;
+}
 
-// #### helper functions #####
-int find_inode_by_name(const char* i_name)
+int fs_advise(const char* filename, int advice)
 {
     if(disk_file_descriptor < 0) {
-        return -1; 
+        return -3; // not mounted
     }
 
-    inode current_inode;
-    for(int i = 0; i < MAX_FILES; i++) {
-        off_t cur_inode_pos = (2 * BLOCK_SIZE) + (i * sizeof(inode));
-        lseek(disk_file_descriptor, cur_inode_pos, SEEK_SET);
+    if(filename == NULL || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME ||
+       advice < FS_ADVICE_NORMAL || advice > FS_ADVICE_DONTNEED) {
+        return -3; // invalid parameters
+    }
 
-        int count_of_reading_buf = read(disk_file_descriptor, &current_inode, sizeof(inode));
-        if(count_of_reading_buf != sizeof(inode)) {
-            return -1; // error while reading the inode
-        }
+    int inode_index = find_inode_by_name(filename);
+    if(inode_index < 0) {
+        return -1; // file not found
+    }
 
-        //looking for the inode with the given name
-        if(current_inode.used && compare_strings(current_inode.name, i_name) == 0) {
-            return i; // return the indx the inode
-        }
+    inode file_inode;
+    read_inode_from_disk(inode_index, &file_inode);
+    int file_blocks = (file_inode.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    switch(advice) {
+        case FS_ADVICE_WILLNEED:
+            // staged data is already in memory, only blocks on the image need reading
+            advise_file_blocks(file_inode.blocks, 0, file_blocks, POSIX_FADV_WILLNEED);
+            break;
+        case FS_ADVICE_DONTNEED:
+            advise_file_blocks(file_inode.blocks, 0, file_blocks, POSIX_FADV_DONTNEED);
+            inode_drop_behind[inode_index] = 1;
+            break;
+        default:
+            inode_access_patterns[inode_index] = (unsigned char)advice;
+            if(advice == FS_ADVICE_NORMAL) {
+                inode_drop_behind[inode_index] = 0;
+            }
+            break;
     }
-    return -1; //there is no inode with this i_name
+    return 0;
 }
 
-int compare_strings(const char* str1, const char* str2)
+int fs_fallocate(const char* filename, int length, int mode)
 {
-    if(str1 == NULL || str2 == NULL) {
-        return 0; // TODO::Adi - null == null -> True (?) - **should check this**
+    if(disk_file_descriptor < 0) {
+        return -3; // not mounted
     }
 
-    while (*str1 && *str1 == *str2)
-    {
-        str1++, str2++;
+    if(filename == NULL || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME ||
+       length <= 0 || (mode & ~FS_FALLOC_KEEP_SIZE)) {
+        return -3; // invalid parameters
     }
 
-    return *str1 - *str2;
-}
+    if(length > MAX_DIRECT_BLOCKS * BLOCK_SIZE) {
+        return -2; // larger than the biggest possible file
+    }
 
-int find_free_inode()
-{
-    if(disk_file_descriptor < 0) {
-        return -1;
+    int inode_index = find_inode_by_name(filename);
+    if(inode_index < 0) {
+        return -1; // file not found
     }
 
-    inode current_inode;
-    for(int i = 0; i < MAX_FILES; i++) {
-        off_t cur_inode_pos = (2 * BLOCK_SIZE) + (i * sizeof(inode));
-        lseek(disk_file_descriptor, cur_inode_pos, SEEK_SET);
+    // preallocation works on the real block map, so staged data gets its blocks first
+    int pending_slot = find_delayed_write_slot(inode_index);
+    if(pending_slot >= 0 && flush_delayed_write(pending_slot) < 0) {
+        return -3;
+    }
 
-        int count_of_reading_buf = read(disk_file_descriptor, &current_inode, sizeof(inode));
-        if(count_of_reading_buf != sizeof(inode)) {
-            return -1;
-        }
+    inode file_inode;
+    read_inode_from_disk(inode_index, &file_inode);
 
-        if(!current_inode.used) {
-            return i; //return the first free inode
-        }
+    int blocks_needed = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int missing_blocks = blocks_needed - count_file_allocated_blocks_in_range(&file_inode, blocks_needed);
+    if(missing_blocks > current_superblock.free_blocks - delayed_reserved_blocks) {
+        return -2; // not enough space available
     }
-    return -1; // no free inodes available
-}
 
+    // remember which blocks hold data right now, everything else needs zeroing if it becomes visible
+    int old_data_blocks = (file_inode.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int had_block[MAX_DIRECT_BLOCKS];
+    for(int i = 0; i < MAX_DIRECT_BLOCKS; i++) {
+        had_block[i] = (file_inode.blocks[i] != 0 && i < old_data_blocks);
+    }
 
-int find_free_block()
-{
-    if (validate_block_number_and_filesystem(0) != 0) {
-        return -1;
+    int allocate_result = allocate_contiguous_blocks_for_file(&file_inode, blocks_needed);
+    if(allocate_result < 0) {
+        flush_metadata_caches();
+        return allocate_result;
     }
 
-    unsigned char block_allocation_bitmap[BLOCK_SIZE];
-    if (read_bitmap_from_disk(block_allocation_bitmap) != 0) {
-        return -1; // error reading bitmap
+    int new_size = file_inode.size;
+    if(!(mode & FS_FALLOC_KEEP_SIZE) && length > file_inode.size) {
+        new_size = length;
     }
 
-    //LOOKING FOR THE FIRST FREE BLOCK
-    // we start looking from block 10 because blocks 0-9 are used for superblock, bitmap and inode table
-    for(int block_index = 10; block_index < MAX_BLOCKS; block_index++) 
-    {
-        if(!(block_allocation_bitmap[block_index / 8] & (1 << (block_index % 8)))) 
-        {
-            return block_index; 
+    // blocks inside the new size must read back as zeros, the ones past it are
+    // zeroed later, when a write or a size change makes them part of the file
+    int visible_blocks = (new_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    for(int i = 0; i < blocks_needed && i < visible_blocks; i++) {
+        if(!had_block[i] && zero_file_blocks(&file_inode, i, 1) < 0) {
+            flush_metadata_caches(); // the blocks are not referenced yet, they only leak until the next mount
+            return -3;
         }
     }
-    return -1; //didnt found a free block available
+    file_inode.size = new_size;
+    if(blocks_needed > inode_preallocated_blocks[inode_index]) {
+        inode_preallocated_blocks[inode_index] = blocks_needed; // shorter rewrites must not give these back
+    }
+
+    write_inode_to_disk(inode_index, &file_inode);
+    flush_metadata_caches();
+    return 0;
 }
 
-void write_inode_to_disk(int inode_index, const inode* i_node)
+int fs_truncate(const char* filename, int new_size)
 {
-    if(disk_file_descriptor < 0 || inode_index < 0 || inode_index >= MAX_FILES || i_node == NULL) 
-    {
-        return;
+    if(disk_file_descriptor < 0) {
+        return -3; // not mounted
     }
 
-    off_t cur_inode_pos = (2 * BLOCK_SIZE) + (inode_index * sizeof(inode));
-    lseek(disk_file_descriptor, cur_inode_pos, SEEK_SET);
-    write(disk_file_descriptor, i_node, sizeof(inode));
-}
+    if(filename == NULL || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME || new_size < 0) {
+        return -3; // invalid parameters
+    }
 
-void mark_block_as_used(int block_index)
-{
-    if (validate_block_number_and_filesystem(block_index) != 0) {
-        return; // invalid parameters
+    if(new_size > MAX_DIRECT_BLOCKS * BLOCK_SIZE) {
+        return -2; // larger than the biggest possible file
+    }
+
+    int inode_index = find_inode_by_name(filename);
+    if(inode_index < 0) {
+        return -1; // file not found
     }
 
-    unsigned char block_allocation_bitmap[BLOCK_SIZE];
-    if (read_bitmap_from_disk(block_allocation_bitmap) != 0) {
-        return; // error reading bitmap
+    // truncate works on the real block map, so staged data gets its blocks first
+    int pending_slot = find_delayed_write_slot(inode_index);
+    if(pending_slot >= 0 && flush_delayed_write(pending_slot) < 0) {
+        return -3;
     }
 
+    inode file_inode;
+    read_inode_from_disk(inode_index, &file_inode);
+
+    int old_data_blocks = (file_inode.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int new_data_blocks = (new_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    if(new_size < file_inode.size) {
+        // the cut-off bytes of the new last block must not reappear if the file grows again.
+        // they are zeroed before any block is released, so a failed write leaves the block map and bitmap alone
+        int tail_offset = new_size % BLOCK_SIZE;
+        int last_block = (new_data_blocks > 0) ? file_inode.blocks[new_data_blocks - 1] : 0;
+        if(tail_offset != 0 && last_block != 0) {
+            static const char zero_tail_buffer[BLOCK_SIZE] = {0};
+            lseek(disk_file_descriptor, (off_t)last_block * BLOCK_SIZE + tail_offset, SEEK_SET);
+            if(write(disk_file_descriptor, zero_tail_buffer, BLOCK_SIZE - tail_offset) != BLOCK_SIZE - tail_offset) {
+                return -3;
+            }
+        }
 
-    //mark the block as used (bit =1) (from the task instructions - bitwise manipulation)
-    block_allocation_bitmap[block_index / 8] |= (1 << (block_index % 8));
-    write_bitmap_to_disk(block_allocation_bitmap);
+        // shrinking: every block past the new end goes back to the free list,
+        // a preallocated tail included, and the preallocation ends with it
+        inode_preallocated_blocks[inode_index] = 0;
+        for(int i = new_data_blocks; i < MAX_DIRECT_BLOCKS; i++) {
+            if(file_inode.blocks[i] != 0 && file_inode.blocks[i] < MAX_BLOCKS) {
+                mark_block_as_free(file_inode.blocks[i]);
+                file_inode.blocks[i] = 0;
+            }
+        }
+    } else if(new_size > file_inode.size) {
+        // growing: no allocation, the new range is a hole - only preallocated blocks
+        // that now become part of the file have to be zeroed
+        if(zero_file_blocks(&file_inode, old_data_blocks, new_data_blocks - old_data_blocks) < 0) {
+            return -3;
+        }
+    }
+
+    file_inode.size = new_size;
+    write_inode_to_disk(inode_index, &file_inode);
+    flush_metadata_caches(); // the inode stops referencing the cut blocks before the bitmap frees them
+    return 0;
 }
 
-void mark_block_as_free(int block_index)
+int fs_stat(const char* filename, fs_file_stat* stat_buffer)
 {
-    if (validate_block_number_and_filesystem(block_index) != 0) {
-        return; 
+    if(disk_file_descriptor < 0) {
+        return -3; // not mounted
     }
-    unsigned char block_allocation_bitmap[BLOCK_SIZE];
-    if (read_bitmap_from_disk(block_allocation_bitmap) != 0) {
-        return; // error reading bitmap
+
+    if(filename == NULL || stat_buffer == NULL || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME) {
+        return -3; // invalid parameters
     }
 
-    //mark the block as free (bit =0) from the task instructions - bitwise manipulation)
-    block_allocation_bitmap[block_index / 8] &= ~(1 << (block_index % 8));
-    write_bitmap_to_disk(block_allocation_bitmap);
+    int inode_index = find_inode_by_name(filename);
+    if(inode_index < 0) {
+        return -1; // file not found
+    }
+
+    const int* block_map = inode_block_maps[inode_index];
+    memset(stat_buffer, 0, sizeof(fs_file_stat));
+    stat_buffer->size = inode_sizes[inode_index];
+    stat_buffer->generation = inode_generations[inode_index];
+
+    // walk the direct pointers once: count blocks, runs, holes and the preallocated tail
+    int data_blocks = (inode_sizes[inode_index] + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int previous_block = 0;
+    for(int i = 0; i < MAX_DIRECT_BLOCKS; i++) {
+        int block_number = block_map[i];
+        if(block_number == 0) {
+            if(i < data_blocks) {
+                stat_buffer->layout_flags |= FS_LAYOUT_HAS_HOLES;
+            }
+            previous_block = 0;
+            continue;
+        }
+
+        stat_buffer->blocks++;
+        if(i >= data_blocks) {
+            stat_buffer->layout_flags |= FS_LAYOUT_PREALLOCATED;
+        }
+        if(previous_block == 0 || block_number != previous_block + 1) {
+            stat_buffer->extents++;
+        }
+        previous_block = block_number;
+    }
+    if(stat_buffer->extents == 1) {
+        stat_buffer->layout_flags |= FS_LAYOUT_CONTIGUOUS;
+    }
+
+    // staged contents replace the on-disk ones once they are flushed
+    int pending_slot = find_delayed_write_slot(inode_index);
+    if(pending_slot >= 0) {
+        stat_buffer->size = delayed_writes[pending_slot].size;
+        stat_buffer->layout_flags |= FS_LAYOUT_STAGED;
+    }
+
+    return 0;
 }
 
-int validate_block_number_and_filesystem(int i_block_num)
+int fs_exists(const char* filename)
 {
-    if(disk_file_descriptor < 0 || i_block_num < 0 || i_block_num >= MAX_BLOCKS) 
-    {
-        return -1;
+    if(disk_file_descriptor < 0) {
+        return -3; // not mounted
     }
 
-    return 0; // valid block number and filesystem
+    if(filename == NULL || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME) {
+        return -3; // invalid parameters
+    }
+
+    return (find_inode_by_name(filename) >= 0) ? 1 : 0;
 }
 
-int read_bitmap_from_disk(unsigned char* i_bitmap_buffer)
+int fs_create_many(const char* const* filenames, int count, int* results)
 {
-    if(disk_file_descriptor < 0 || i_bitmap_buffer == NULL) 
-    {
-        return -1;
+    if(disk_file_descriptor < 0 || filenames == NULL || count < 0) {
+        return -3; // not mounted or invalid parameters
     }
 
-    lseek(disk_file_descriptor, BLOCK_SIZE, SEEK_SET);
-    int num_of_reading_byte = read(disk_file_descriptor, i_bitmap_buffer, BLOCK_SIZE);
-    if(num_of_reading_byte != BLOCK_SIZE) 
-    {
-        return -1;
+    // the creates only touch the cached table, so the whole batch costs one write-back
+    metadata_flush_deferred++;
+    int created = 0;
+    for(int i = 0; i < count; i++) {
+        int result = fs_create(filenames[i]);
+        if(result == 0) {
+            created++;
+        }
+        if(results != NULL) {
+            results[i] = result;
+        }
     }
 
-    return 0; 
+    metadata_flush_deferred--;
+    flush_metadata_caches();
+    return created;
 }
 
-int write_bitmap_to_disk(const unsigned char* i_bitmap_buffer)
+int fs_delete_many(const char* const* filenames, int count, int* results)
 {
-    if(disk_file_descriptor < 0 || i_bitmap_buffer == NULL) 
-    {
-        return -1;
+    if(disk_file_descriptor < 0 || filenames == NULL || count < 0) {
+        return -3; // not mounted or invalid parameters
     }
 
-    lseek(disk_file_descriptor, BLOCK_SIZE, SEEK_SET);
-    int num_of_writing_byte = write(disk_file_descriptor, i_bitmap_buffer, BLOCK_SIZE);
-    if(num_of_writing_byte != BLOCK_SIZE) 
-    {
-        return -1;
+    // same checks as fs_delete, but the inode table and the bitmap are flushed once for the batch
+    int deleted = 0;
+    for(int i = 0; i < count; i++) {
+        const char* filename = filenames[i];
+        int result;
+        if(filename == NULL || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME) {
+            result = -2;
+        } else {
+            int inode_index = find_inode_by_name(filename);
+            result = (inode_index < 0) ? -1 : release_file_inode(inode_index);
+        }
+
+        if(result == 0) {
+            deleted++;
+        }
+        if(results != NULL) {
+            results[i] = result;
+        }
     }
 
-    return 0; 
+    flush_metadata_caches();
+    return deleted;
 }
 
-
-void read_inode_from_disk(int i_inode_index, inode* i_inode_buffer)
+int fs_stat_many(const char* const* filenames, int count, fs_file_stat* stat_buffers, int* results)
 {
-    if(disk_file_descriptor < 0 || i_inode_index < 0 || i_inode_index >= MAX_FILES || i_inode_buffer == NULL) 
-    {
-        return; // invalid parameters
+    if(disk_file_descriptor < 0 || filenames == NULL || stat_buffers == NULL || count < 0) {
+        return -3; // not mounted or invalid parameters
     }
 
-    off_t cur_inode_pos = (2 * BLOCK_SIZE) + (i_inode_index * sizeof(inode));
-    lseek(disk_file_descriptor, cur_inode_pos, SEEK_SET);
-    read(disk_file_descriptor, i_inode_buffer, sizeof(inode));
+    // served from the inode cache, no disk access at all
+    int found = 0;
+    for(int i = 0; i < count; i++) {
+        fs_file_stat stat_buffer;
+        int result = fs_stat(filenames[i], &stat_buffer);
+        if(result == 0) {
+            stat_buffers[i] = stat_buffer;
+            found++;
+        }
+        if(results != NULL) {
+            results[i] = result;
+        }
+    }
+    return found;
 }
 
-int validate_write_operation_parameters(const char* filename, const void* data, int size) 
+fs_transaction* fs_transaction_begin(void)
 {
-    if(disk_file_descriptor < 0) {
-        return -3; // not mounted
-    }
+    return calloc(1, sizeof(fs_transaction));
+}
 
-    if(filename == NULL || data == NULL || size <= 0 || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME) {
+int fs_transaction_write(fs_transaction* transaction, const char* filename, const void* data, int size)
+{
+    if(transaction == NULL || filename == NULL || data == NULL || size <= 0 ||
+       strlen(filename) == 0 || strlen(filename) > MAX_FILENAME) {
         return -3; // invalid parameters
     }
-
-    //maximum file size limit is using all the 12 blocks * 4KB = 48KB)
-    if (size > MAX_DIRECT_BLOCKS * BLOCK_SIZE) {
+    if(size > MAX_DIRECT_BLOCKS * BLOCK_SIZE) {
         return -2; // file too large for the filesystem
     }
-    
-    return 0; // validation passed
+
+    char* data_copy = malloc(size);
+    if(data_copy == NULL) {
+        return -3;
+    }
+    transaction_operation* operation = record_transaction_operation(transaction, filename);
+    if(operation == NULL) {
+        free(data_copy);
+        return -3;
+    }
+
+    memcpy(data_copy, data, size);
+    operation->is_delete = 0;
+    operation->size = size;
+    operation->data = data_copy;
+    return 0;
 }
 
-int check_available_space_for_write_operation(int blocks_needed, int current_file_size) 
+int fs_transaction_delete(fs_transaction* transaction, const char* filename)
 {
-    int current_file_blocks = (current_file_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    if (blocks_needed > current_superblock.free_blocks + current_file_blocks) {
-        return -2; // not enough space available
+    if(transaction == NULL || filename == NULL || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME) {
+        return -3; // invalid parameters
     }
-    
-    return 0; // enough space
+
+    transaction_operation* operation = record_transaction_operation(transaction, filename);
+    if(operation == NULL) {
+        return -3;
+    }
+    operation->is_delete = 1;
+    return 0;
 }
 
-int free_file_existing_blocks(inode* file_inode) 
+int fs_transaction_commit(fs_transaction* transaction)
 {
-    if (file_inode == NULL) {
-        return -3; // invalid parameter
+    if(transaction == NULL) {
+        return -3; // invalid parameters
+    }
+
+    // staged writes go to disk first and the group is applied with delayed allocation off,
+    // so every write of the group frees and allocates at once and validation can count it exactly
+    if(flush_all_delayed_writes() < 0) {
+        fs_transaction_abort(transaction);
+        return -3;
+    }
+    int saved_policy_flags = write_policy_flags;
+    write_policy_flags &= ~FS_POLICY_DELAYED_ALLOCATION;
+
+    // nothing is applied unless the whole group is known to fit
+    int result = validate_transaction(transaction);
+    if(result == 0) {
+        metadata_flush_deferred++; // fs_sync below writes the whole group at once
+        result = apply_transaction(transaction);
+        metadata_flush_deferred--;
+        if(result != 0) {
+            flush_metadata_caches(); // what was applied before the failure still has to reach the disk in order
+        }
+    }
+    write_policy_flags = saved_policy_flags;
+    if(result == 0 && fs_sync() != 0) {
+        result = -3;
+    }
+
+    fs_transaction_abort(transaction);
+    return result;
+}
+
+void fs_transaction_abort(fs_transaction* transaction)
+{
+    if(transaction == NULL) {
+        return;
+    }
+
+    for(int i = 0; i < transaction->count; i++) {
+        free(transaction->operations[i].data);
+    }
+    free(transaction->operations);
+    free(transaction);
+}
+
+int fs_write_stream_open(const char* filename, fs_write_stream** stream)
+{
+    if(disk_file_descriptor < 0 || stream == NULL) {
+        return -3; // not mounted or invalid parameters
+    }
+
+    if(filename == NULL || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME) {
+        return -3; // invalid parameters
+    }
+
+    if(find_inode_by_name(filename) < 0) {
+        return -1; // file not found
+    }
+
+    fs_write_stream* new_stream = calloc(1, sizeof(fs_write_stream));
+    if(new_stream == NULL) {
+        return -3;
+    }
+    strncpy(new_stream->name, filename, MAX_FILENAME);
+    new_stream->next_open = open_write_streams;
+    open_write_streams = new_stream;
+
+    *stream = new_stream;
+    return 0;
+}
+
+int fs_write_stream_write(fs_write_stream* stream, const void* data, int size)
+{
+    if(stream == NULL || (data == NULL && size != 0) || size < 0 || stream->detached) {
+        return -3; // invalid parameters or the filesystem went away
+    }
+
+    if(size > MAX_DIRECT_BLOCKS * BLOCK_SIZE - stream->size) {
+        return -2; // file too large for the filesystem
+    }
+
+    // a full buffer goes out once more data arrives (or at close), so a failed
+    // flush leaves it in place for the next attempt
+    const char* data_bytes = (const char*)data;
+    while(size > 0) {
+        if(stream->buffered == BLOCK_SIZE) {
+            int flush_result = write_stream_flush_block(stream);
+            if(flush_result < 0) {
+                return flush_result;
+            }
+        }
+
+        int chunk = BLOCK_SIZE - stream->buffered;
+        if(chunk > size) {
+            chunk = size;
+        }
+        memcpy(stream->block_buffer + stream->buffered, data_bytes, chunk);
+        stream->buffered += chunk;
+        stream->size += chunk;
+        data_bytes += chunk;
+        size -= chunk;
+    }
+    return 0;
+}
+
+int fs_write_stream_close(fs_write_stream* stream)
+{
+    if(stream == NULL) {
+        return -3; // invalid parameters
+    }
+
+    if(stream->detached) {
+        fs_write_stream_abort(stream);
+        return -3; // fs_unmount already took the blocks back
+    }
+
+    int inode_index = find_inode_by_name(stream->name);
+    if(inode_index < 0) {
+        fs_write_stream_abort(stream);
+        return -1; // deleted while the stream was open
+    }
+
+    if(stream->buffered > 0) {
+        // bytes past the end of the file stay zero on disk
+        memset(stream->block_buffer + stream->buffered, 0, BLOCK_SIZE - stream->buffered);
+        int flush_result = write_stream_flush_block(stream);
+        if(flush_result < 0) {
+            fs_write_stream_abort(stream);
+            return flush_result;
+        }
+    }
+
+    // the stream supersedes staged data and every block the file owned before
+    int pending_slot = find_delayed_write_slot(inode_index);
+    if(pending_slot >= 0) {
+        discard_delayed_write(pending_slot);
+    }
+    inode file_inode;
+    read_inode_from_disk(inode_index, &file_inode);
+    free_file_existing_blocks(&file_inode);
+    inode_preallocated_blocks[inode_index] = 0;
+
+    // publish the new contents with a single inode update
+    memcpy(file_inode.blocks, stream->blocks, sizeof(file_inode.blocks));
+    file_inode.size = stream->size;
+    write_inode_to_disk(inode_index, &file_inode);
+    flush_metadata_caches();
+
+    stream->blocks_written = 0; // the blocks belong to the file now
+    fs_write_stream_abort(stream);
+    return 0;
+}
+
+void fs_write_stream_abort(fs_write_stream* stream)
+{
+    if(stream == NULL) {
+        return;
+    }
+
+    if(!stream->detached) {
+        write_stream_release(stream);
+        flush_metadata_caches();
+    }
+
+    fs_write_stream** link = &open_write_streams;
+    while(*link != NULL && *link != stream) {
+        link = &(*link)->next_open;
+    }
+    if(*link == stream) {
+        *link = stream->next_open;
+    }
+    free(stream);
+}
+
+int fs_read_stream_open(const char* filename, fs_read_stream** stream)
+{
+    if(disk_file_descriptor < 0 || stream == NULL) {
+        return -3; // not mounted or invalid parameters
+    }
+
+    if(filename == NULL || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME) {
+        return -3; // invalid parameters
+    }
+
+    int inode_index = find_inode_by_name(filename);
+    if(inode_index < 0) {
+        return -1; // file not found
+    }
+
+    // the stream reads blocks, so staged data has to reach them first
+    int pending_slot = find_delayed_write_slot(inode_index);
+    if(pending_slot >= 0 && flush_delayed_write(pending_slot) < 0) {
+        return -3;
+    }
+
+    fs_read_stream* new_stream = malloc(sizeof(fs_read_stream));
+    if(new_stream == NULL) {
+        return -3;
+    }
+    inode file_inode;
+    read_inode_from_disk(inode_index, &file_inode);
+    new_stream->inode_index = inode_index;
+    new_stream->generation = inode_generations[inode_index];
+    new_stream->size = file_inode.size;
+    memcpy(new_stream->blocks, file_inode.blocks, sizeof(new_stream->blocks));
+    new_stream->position = 0;
+    new_stream->buffer_first_block = -1;
+    new_stream->buffer_blocks = 0;
+    new_stream->access_pattern = inode_access_patterns[inode_index];
+    new_stream->drop_behind = inode_drop_behind[inode_index];
+    new_stream->prefetched_until = 0;
+    // hinted files start at the window they keep: whole files ahead, or nothing ahead
+    if(new_stream->access_pattern == FS_ADVICE_SEQUENTIAL) {
+        new_stream->readahead_blocks = READ_AHEAD_MAX_BLOCKS;
+    } else if(new_stream->access_pattern == FS_ADVICE_RANDOM) {
+        new_stream->readahead_blocks = READ_AHEAD_MIN_BLOCKS;
+    } else {
+        new_stream->readahead_blocks = READ_AHEAD_INITIAL_BLOCKS;
+    }
+
+    *stream = new_stream;
+    return 0;
+}
+
+int fs_read_stream_next(fs_read_stream* stream, const void** chunk)
+{
+    if(stream == NULL || chunk == NULL) {
+        return -3; // invalid parameters
+    }
+
+    const char* buffered_chunk;
+    int available = read_stream_buffered_bytes(stream, &buffered_chunk);
+    if(available <= 0) {
+        return available; // end of file or error
+    }
+
+    // hand out at most up to the end of the current block
+    int chunk_bytes = BLOCK_SIZE - stream->position % BLOCK_SIZE;
+    if(chunk_bytes > available) {
+        chunk_bytes = available;
+    }
+    stream->position += chunk_bytes;
+    *chunk = buffered_chunk;
+    return chunk_bytes;
+}
+
+int fs_read_stream_seek(fs_read_stream* stream, int offset)
+{
+    if(stream == NULL || offset < 0 || offset > stream->size) {
+        return -3; // invalid parameters
+    }
+
+    stream->position = offset;
+    return 0;
+}
+
+int fs_read_stream_window(const fs_read_stream* stream)
+{
+    if(stream == NULL) {
+        return -3; // invalid parameters
+    }
+    return stream->readahead_blocks;
+}
+
+void fs_read_stream_close(fs_read_stream* stream)
+{
+    if(stream != NULL && stream->drop_behind && disk_file_descriptor >= 0) {
+        read_stream_drop_buffered(stream);
+    }
+    free(stream);
+}
+
+int fs_read_to_sink(const char* filename, fs_read_sink sink, void* user_data)
+{
+    if(sink == NULL) {
+        return -3; // invalid parameters
+    }
+
+    fs_read_stream* stream;
+    int open_result = fs_read_stream_open(filename, &stream);
+    if(open_result < 0) {
+        return open_result;
+    }
+
+    // every buffered extent goes to the sink in one call
+    int delivered = 0;
+    for(;;) {
+        const char* chunk;
+        int available = read_stream_buffered_bytes(stream, &chunk);
+        if(available <= 0) {
+            if(available < 0) {
+                delivered = available;
+            }
+            break;
+        }
+        stream->position += available;
+        if(sink(chunk, available, user_data) != 0) {
+            delivered += available;
+            break; // the sink has had enough
+        }
+        delivered += available;
+    }
+
+    fs_read_stream_close(stream);
+    return delivered;
+}
+
+int fs_export_to_fd(const char* filename, int out_fd)
+{
+    if(disk_file_descriptor < 0 || out_fd < 0) {
+        return -3; // not mounted or invalid parameters
+    }
+
+    if(filename == NULL || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME) {
+        return -3; // invalid parameters
+    }
+
+    int inode_index = find_inode_by_name(filename);
+    if(inode_index < 0) {
+        return -1; // file not found
+    }
+
+    // the kernel copies from the image, so staged data has to be there first
+    int pending_slot = find_delayed_write_slot(inode_index);
+    if(pending_slot >= 0 && flush_delayed_write(pending_slot) < 0) {
+        return -3;
+    }
+
+    inode file_inode;
+    read_inode_from_disk(inode_index, &file_inode);
+    int file_blocks = (file_inode.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    // one transfer per run of physically consecutive blocks, zeros for holes
+    int use_sendfile = 0;
+    int exported = 0;
+    int block_index = 0;
+    while(block_index < file_blocks) {
+        int first_physical = file_inode.blocks[block_index];
+        int run_blocks = 1;
+        while(block_index + run_blocks < file_blocks &&
+              (first_physical == 0 ? file_inode.blocks[block_index + run_blocks] == 0
+                                   : file_inode.blocks[block_index + run_blocks] == first_physical + run_blocks)) {
+            run_blocks++;
+        }
+
+        int run_bytes = run_blocks * BLOCK_SIZE;
+        if(exported + run_bytes > file_inode.size) {
+            run_bytes = file_inode.size - exported; // the last block is only partly used
+        }
+
+        int result;
+        if(first_physical == 0) {
+            result = export_zeros(run_bytes, out_fd);
+        } else if(first_physical < FIRST_DATA_BLOCK || first_physical + run_blocks > MAX_BLOCKS) {
+            result = -3; // invalid block index
+        } else {
+            result = export_image_range((off_t)first_physical * BLOCK_SIZE, run_bytes, out_fd, &use_sendfile);
+        }
+        if(result < 0) {
+            return -3;
+        }
+
+        exported += run_bytes;
+        block_index += run_blocks;
+    }
+    return exported;
+}
+
+int fs_statfs(fs_statfs_info* info)
+{
+    if(disk_file_descriptor < 0 || info == NULL) {
+        return -3; // not mounted or invalid parameter
+    }
+
+    // the extent count is exact at all times, only the largest extent is rebuilt -
+    // once, and only after the free space changed
+    if(!largest_free_extent_valid) {
+        largest_free_extent = find_largest_free_extent();
+        largest_free_extent_valid = 1;
+    }
+
+    memset(info, 0, sizeof(fs_statfs_info));
+    info->total_blocks = MAX_BLOCKS - FIRST_DATA_BLOCK;
+    info->free_blocks = current_superblock.free_blocks;
+    info->reserved_blocks = delayed_reserved_blocks;
+    info->available_blocks = current_superblock.free_blocks - delayed_reserved_blocks;
+    info->total_inodes = MAX_FILES;
+    info->free_inodes = current_superblock.free_inodes;
+    info->free_extents = free_extents_count;
+    info->largest_free_extent = largest_free_extent;
+    if(current_superblock.free_blocks > 0) {
+        info->fragmentation_percent = 100 - (100 * largest_free_extent) / current_superblock.free_blocks;
+    }
+    return 0;
+}
+
+int fs_list_next(fs_list_cursor* cursor, fs_dirent* entries, int max_entries)
+{
+    if(disk_file_descriptor < 0 || cursor == NULL || entries == NULL || max_entries < 0) {
+        return -1;
+    }
+
+    // the cursor is the inode index to resume from, so a page never revisits earlier slots
+    int num_of_files_found = 0;
+    int i = (cursor->position > 0) ? cursor->position : 0;
+    for(; i < MAX_FILES && num_of_files_found < max_entries; i++) {
+        if(!inode_is_used(i)) {
+            continue;
+        }
+
+        int pending_slot = find_delayed_write_slot(i);
+        entries[num_of_files_found].name = inode_names[i];
+        entries[num_of_files_found].size = (pending_slot >= 0) ? delayed_writes[pending_slot].size : inode_sizes[i];
+        num_of_files_found++;
+    }
+
+    cursor->position = i;
+    return num_of_files_found;
+}
+
+int fs_list_prefix(const char* prefix, fs_list_cursor* cursor, fs_dirent* entries, int max_entries)
+{
+    if(disk_file_descriptor < 0 || prefix == NULL || strlen(prefix) > MAX_FILENAME ||
+       cursor == NULL || entries == NULL || max_entries < 0) {
+        return -1;
+    }
+
+    return list_ordered_range(prefix, NULL, 0, cursor, entries, max_entries);
+}
+
+int fs_list_glob(const char* pattern, fs_list_cursor* cursor, fs_dirent* entries, int max_entries)
+{
+    if(disk_file_descriptor < 0 || pattern == NULL || cursor == NULL || entries == NULL || max_entries < 0) {
+        return -1;
+    }
+
+    // everything up to the first special character must match literally
+    char literal_prefix[MAX_FILENAME + 1] = {0};
+    int literal_length = strcspn(pattern, "*?[\\");
+    if(literal_length > MAX_FILENAME) {
+        return 0; // a literal part longer than any name matches nothing
+    }
+    memcpy(literal_prefix, pattern, literal_length);
+
+    return list_ordered_range(literal_prefix, pattern, 0, cursor, entries, max_entries);
+}
+
+int fs_mkdir(const char* path)
+{
+    if(disk_file_descriptor < 0) {
+        return -3; // not mounted
+    }
+
+    char directory_name[MAX_FILENAME + 1];
+    if(build_directory_prefix(path, directory_name) < 0 || directory_name[0] == '\0') {
+        return -3; // invalid path
+    }
+
+    // the parent of "a/b" is the marker "a/"
+    char parent_name[MAX_FILENAME + 1] = {0};
+    const char* last_separator = strrchr(path, '/');
+    if(last_separator != NULL) {
+        memcpy(parent_name, path, last_separator - path + 1);
+        if(find_inode_by_name(parent_name) < 0) {
+            return -3; // parent directory does not exist
+        }
+    }
+
+    return fs_create(directory_name);
+}
+
+int fs_rmdir(const char* path)
+{
+    if(disk_file_descriptor < 0) {
+        return -3; // not mounted
+    }
+
+    char directory_name[MAX_FILENAME + 1];
+    if(build_directory_prefix(path, directory_name) < 0 || directory_name[0] == '\0') {
+        return -3; // invalid path
+    }
+
+    int inode_index = find_inode_by_name(directory_name);
+    if(inode_index < 0) {
+        return -1; // no such directory
+    }
+
+    // the marker sorts first in its own range, anything right after it lives inside
+    int position = sorted_name_lower_bound(directory_name, 1);
+    if(position < sorted_name_count &&
+       strncmp(inode_names[sorted_name_index[position]], directory_name, strlen(directory_name)) == 0) {
+        return -2; // directory not empty
+    }
+
+    return (delete_file_by_inode(inode_index) == 0) ? 0 : -3;
+}
+
+int fs_list_dir(const char* path, fs_list_cursor* cursor, fs_dirent* entries, int max_entries)
+{
+    if(disk_file_descriptor < 0 || cursor == NULL || entries == NULL || max_entries < 0) {
+        return -1;
+    }
+
+    char directory_prefix[MAX_FILENAME + 1];
+    if(build_directory_prefix(path, directory_prefix) < 0) {
+        return -1; // invalid path
+    }
+
+    return list_ordered_range(directory_prefix, NULL, 1, cursor, entries, max_entries);
+}
+
+int fs_get_lookup_stats(fs_lookup_stats* stats)
+{
+    if(stats == NULL) {
+        return -3;
+    }
+
+    *stats = name_lookup_stats;
+    return 0;
+}
+
+void fs_reset_lookup_stats(void)
+{
+    memset(&name_lookup_stats, 0, sizeof(name_lookup_stats));
+}
+
+int fs_sync(void)
+{
+    if(disk_file_descriptor < 0) {
+        return -3; // not mounted
+    }
+
+    if(flush_all_delayed_writes() < 0 || flush_metadata_caches() < 0) {
+        return -3;
+    }
+
+    lseek(disk_file_descriptor, 0, SEEK_SET);
+    if(write(disk_file_descriptor, &current_superblock, sizeof(superblock)) != sizeof(superblock)) {
+        return -3;
+    }
+
+    return (fsync(disk_file_descriptor) == 0) ? 0 : -3;
+}
+
+
+
+// #### helper functions #####
+int find_inode_by_name(const char* i_name)
+{
+    if(disk_file_descriptor < 0 || i_name == NULL) {
+        return -1; 
+    }
+
+    // most probes for missing names stop at the Bloom filter
+    name_lookup_stats.lookups++;
+    if(!name_filter_may_contain(i_name)) {
+        name_lookup_stats.filtered_misses++;
+        return -1;
+    }
+
+    // pad the name like the cached ones so each candidate is a single slot compare
+    if(strnlen(i_name, MAX_FILENAME + 1) > MAX_FILENAME) {
+        name_lookup_stats.false_positives++;
+        return -1; // longer than any stored name
+    }
+    char name_slot[NAME_SLOT_SIZE] __attribute__((aligned(NAME_SLOT_SIZE)));
+    load_name_slot(name_slot, i_name);
+
+    //walk the probe chain of the name hash until an empty slot
+    unsigned int slot = hash_file_name(i_name) & (NAME_INDEX_SLOTS - 1);
+    while(name_index_slots[slot] != 0) {
+        int i = name_index_slots[slot] - 1;
+        if(name_slot_equals(inode_names[i], name_slot)) {
+            name_lookup_stats.hits++;
+            return i; // return the indx the inode
+        }
+        slot = (slot + 1) & (NAME_INDEX_SLOTS - 1);
+    }
+    name_lookup_stats.false_positives++;
+    return -1; //there is no inode with this i_name
+}
+
+unsigned int hash_file_name(const char* name)
+{
+    // FNV-1a over the stored part of the name
+    unsigned int hash = 2166136261u;
+    for(int i = 0; i < MAX_FILENAME && name[i] != '\0'; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void name_index_insert(int inode_index)
+{
+    unsigned int slot = hash_file_name(inode_names[inode_index]) & (NAME_INDEX_SLOTS - 1);
+    while(name_index_slots[slot] != 0) {
+        slot = (slot + 1) & (NAME_INDEX_SLOTS - 1);
+    }
+    name_index_slots[slot] = (short)(inode_index + 1);
+}
+
+void name_index_remove(int inode_index)
+{
+    // must run while the cache still holds the old name, its hash leads to the slot
+    unsigned int slot = hash_file_name(inode_names[inode_index]) & (NAME_INDEX_SLOTS - 1);
+    while(name_index_slots[slot] != 0 && name_index_slots[slot] != inode_index + 1) {
+        slot = (slot + 1) & (NAME_INDEX_SLOTS - 1);
+    }
+    if(name_index_slots[slot] == 0) {
+        return; // not indexed
+    }
+
+    // backward shift deletion: pull later entries of the chain into the gap so
+    // lookups never stop early and no tombstones pile up
+    unsigned int gap = slot;
+    unsigned int next = slot;
+    while(1) {
+        next = (next + 1) & (NAME_INDEX_SLOTS - 1);
+        if(name_index_slots[next] == 0) {
+            break;
+        }
+        unsigned int home = hash_file_name(inode_names[name_index_slots[next] - 1]) & (NAME_INDEX_SLOTS - 1);
+        int home_between = (gap <= next) ? (gap < home && home <= next) : (gap < home || home <= next);
+        if(!home_between) {
+            name_index_slots[gap] = name_index_slots[next];
+            gap = next;
+        }
+    }
+    name_index_slots[gap] = 0;
+}
+
+void rebuild_name_index()
+{
+    memset(name_index_slots, 0, sizeof(name_index_slots));
+    memset(name_filter_counters, 0, sizeof(name_filter_counters));
+    memset(&name_lookup_stats, 0, sizeof(name_lookup_stats));
+    sorted_name_count = 0;
+    for(int i = 0; i < MAX_FILES; i++) {
+        if(inode_is_used(i)) {
+            name_index_insert(i);
+            sorted_name_insert(i);
+            name_filter_update(inode_names[i], +1);
+        }
+    }
+}
+
+unsigned int second_hash_file_name(const char* name)
+{
+    // djb2, independent enough from FNV-1a for double hashing
+    unsigned int hash = 5381;
+    for(int i = 0; i < MAX_FILENAME && name[i] != '\0'; i++) {
+        hash = hash * 33 + (unsigned char)name[i];
+    }
+    return hash | 1; // odd, so the probes never collapse onto one counter
+}
+
+void name_filter_update(const char* name, int delta)
+{
+    unsigned int first_hash = hash_file_name(name);
+    unsigned int second_hash = second_hash_file_name(name);
+    for(int probe = 0; probe < NAME_FILTER_PROBES; probe++) {
+        unsigned char* counter = &name_filter_counters[(first_hash + probe * second_hash) % NAME_FILTER_COUNTERS];
+        if(*counter == 255) {
+            continue; // saturated - it no longer knows how many names share it
+        }
+        if(delta > 0) {
+            (*counter)++;
+        } else if(*counter > 0) {
+            (*counter)--;
+        }
+    }
+}
+
+int name_filter_may_contain(const char* name)
+{
+    unsigned int first_hash = hash_file_name(name);
+    unsigned int second_hash = second_hash_file_name(name);
+    for(int probe = 0; probe < NAME_FILTER_PROBES; probe++) {
+        if(name_filter_counters[(first_hash + probe * second_hash) % NAME_FILTER_COUNTERS] == 0) {
+            return 0; // definitely no live file with this name
+        }
+    }
+    return 1;
+}
+
+int compare_file_names(const char* name1, const char* name2)
+{
+    return strncmp(name1, name2, MAX_FILENAME);
+}
+
+int sorted_name_lower_bound(const char* name, int strictly_after)
+{
+    // first position whose name is >= name (or > name when strictly_after is set)
+    int low = 0;
+    int high = sorted_name_count;
+    while(low < high) {
+        int middle = (low + high) / 2;
+        int order = compare_file_names(inode_names[sorted_name_index[middle]], name);
+        if(order < 0 || (strictly_after && order == 0)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void sorted_name_insert(int inode_index)
+{
+    int position = sorted_name_lower_bound(inode_names[inode_index], 1);
+    memmove(&sorted_name_index[position + 1], &sorted_name_index[position],
+            (sorted_name_count - position) * sizeof(sorted_name_index[0]));
+    sorted_name_index[position] = (short)inode_index;
+    sorted_name_count++;
+}
+
+void sorted_name_remove(int inode_index)
+{
+    // like name_index_remove this needs the old name still in the cache
+    int position = sorted_name_lower_bound(inode_names[inode_index], 0);
+    while(position < sorted_name_count && sorted_name_index[position] != inode_index) {
+        position++; // equal names can only exist on an image left behind by a crashed rename
+    }
+    if(position == sorted_name_count) {
+        return; // not indexed
+    }
+
+    memmove(&sorted_name_index[position], &sorted_name_index[position + 1],
+            (sorted_name_count - position - 1) * sizeof(sorted_name_index[0]));
+    sorted_name_count--;
+}
+
+int list_ordered_range(const char* prefix, const char* pattern, int children_only, fs_list_cursor* cursor, fs_dirent* entries, int max_entries)
+{
+    // resume after the last returned name, or start at the beginning of the prefix range
+    int prefix_length = strlen(prefix);
+    int position = (cursor->resume_after[0] != '\0') ? sorted_name_lower_bound(cursor->resume_after, 1)
+                                                      : sorted_name_lower_bound(prefix, 0);
+    int num_of_files_found = 0;
+
+    for(; position < sorted_name_count && num_of_files_found < max_entries; position++) {
+        int i = sorted_name_index[position];
+        const char* current_name = inode_names[i];
+        if(strncmp(current_name, prefix, prefix_length) != 0) {
+            break; // past the end of the prefix range
+        }
+        if(pattern != NULL && fnmatch(pattern, current_name, 0) != 0) {
+            continue;
+        }
+
+        if(children_only && current_name[prefix_length] == '\0') {
+            continue; // the marker of the listed directory itself, its parent lists it
+        }
+
+        const char* separator = strchr(current_name + prefix_length, '/');
+        if(children_only && separator != NULL && separator[1] != '\0') {
+            // an entry of a subdirectory: its whole subtree sorts together, so jump past it
+            // by searching for the name that follows "<prefix><child>/" ('0' comes right after '/')
+            char subtree_end[MAX_FILENAME + 1] = {0};
+            int subtree_prefix_length = separator - current_name;
+            memcpy(subtree_end, current_name, subtree_prefix_length);
+            subtree_end[subtree_prefix_length] = '/' + 1;
+            position = sorted_name_lower_bound(subtree_end, 0) - 1;
+            continue;
+        }
+
+        int pending_slot = find_delayed_write_slot(i);
+        entries[num_of_files_found].name = current_name;
+        entries[num_of_files_found].size = (pending_slot >= 0) ? delayed_writes[pending_slot].size : inode_sizes[i];
+        num_of_files_found++;
+    }
+
+    // remember the last name this page looked at, matching or not
+    if(position > 0 && position <= sorted_name_count) {
+        strncpy(cursor->resume_after, inode_names[sorted_name_index[position - 1]], MAX_FILENAME);
+        cursor->resume_after[MAX_FILENAME] = '\0';
+    }
+    return num_of_files_found;
+}
+
+int compare_strings(const char* str1, const char* str2)
+{
+    if(str1 == NULL || str2 == NULL) {
+        return 0; // TODO::Adi - null == null -> True (?) - **should check this**
+    }
+
+    while (*str1 && *str1 == *str2)
+    {
+        str1++, str2++;
+    }
+
+    return *str1 - *str2;
+}
+
+int find_free_inode()
+{
+    if(disk_file_descriptor < 0) {
+        return -1;
+    }
+
+    // only a peek: the inode leaves the stack when write_inode_to_disk marks it used
+    if(free_inode_count == 0) {
+        return -1; // no free inodes available
+    }
+    return free_inode_stack[free_inode_count - 1];
+}
+
+void rebuild_free_inode_stack()
+{
+    // pushed from the top down, so a fresh table hands out inode 0 first
+    free_inode_count = 0;
+    for(int i = MAX_FILES - 1; i >= 0; i--) {
+        free_inode_stack_position[i] = -1;
+        if(!inode_is_used(i)) {
+            free_inode_stack_push(i);
+        }
+    }
+}
+
+void free_inode_stack_push(int inode_index)
+{
+    free_inode_stack_position[inode_index] = free_inode_count;
+    free_inode_stack[free_inode_count++] = inode_index;
+}
+
+void free_inode_stack_remove(int inode_index)
+{
+    int position = free_inode_stack_position[inode_index];
+    if(position < 0) {
+        return;
+    }
+
+    // normally the top; anything else swaps with the top to stay O(1)
+    int top_inode = free_inode_stack[--free_inode_count];
+    free_inode_stack[position] = top_inode;
+    free_inode_stack_position[top_inode] = position;
+    free_inode_stack_position[inode_index] = -1;
+}
+
+
+int find_free_block()
+{
+    if (validate_block_number_and_filesystem(0) != 0) {
+        return -1;
+    }
+
+    // in log mode we search next-fit from the log head and wrap around once,
+    // otherwise we look for the first free block of the data region
+    // (blocks 0-9 are used for superblock, bitmap and inode table)
+    int start_block = (write_policy_flags & FS_POLICY_LOG_STRUCTURED) ? log_head_block : FIRST_DATA_BLOCK;
+    int data_blocks_count = MAX_BLOCKS - FIRST_DATA_BLOCK;
+
+    for(int step = 0; step < data_blocks_count; step++) 
+    {
+        int block_index = FIRST_DATA_BLOCK + (start_block - FIRST_DATA_BLOCK + step) % data_blocks_count;
+        if(!(block_bitmap_cache[block_index / 8] & (1 << (block_index % 8)))) 
+        {
+            return block_index; 
+        }
+    }
+    return -1; //didnt found a free block available
+}
+
+void write_inode_to_disk(int inode_index, const inode* i_node)
+{
+    if(disk_file_descriptor < 0 || inode_index < 0 || inode_index >= MAX_FILES || i_node == NULL) 
+    {
+        return;
+    }
+
+    // keep the name index in step with the cached copy when the name or the used flag changes
+    char name_slot[NAME_SLOT_SIZE] __attribute__((aligned(NAME_SLOT_SIZE)));
+    load_name_slot(name_slot, i_node->name);
+    int was_used = inode_is_used(inode_index);
+    int name_changed = was_used != (i_node->used != 0) || !name_slot_equals(inode_names[inode_index], name_slot);
+    if(name_changed && was_used) {
+        name_index_remove(inode_index);
+        sorted_name_remove(inode_index);
+        name_filter_update(inode_names[inode_index], -1);
+    }
+    store_inode_in_cache(inode_index, i_node);
+    if(was_used && !i_node->used) {
+        free_inode_stack_push(inode_index);
+    } else if(!was_used && i_node->used) {
+        free_inode_stack_remove(inode_index);
+    }
+    if(name_changed && i_node->used) {
+        name_index_insert(inode_index);
+        sorted_name_insert(inode_index);
+        name_filter_update(inode_names[inode_index], +1);
+    }
+    inode_generations[inode_index] = ++generation_clock;
+
+    // written back by flush_inode_table_cache as whole blocks; an inode can straddle two of them
+    int first_byte = inode_index * sizeof(inode);
+    int last_byte = first_byte + sizeof(inode) - 1;
+    for(int block = first_byte / BLOCK_SIZE; block <= last_byte / BLOCK_SIZE; block++) {
+        inode_table_dirty_blocks |= 1u << block;
+    }
+}
+
+void mark_block_as_used(int block_index)
+{
+    if (validate_block_number_and_filesystem(block_index) != 0) {
+        return; // invalid parameters
+    }
+
+    if (block_index >= FIRST_DATA_BLOCK && is_data_block_free(block_index)) {
+        // the free counters follow the bitmap, so they can never drift from it.
+        // taking a block splits, shortens or removes exactly one free extent
+        current_superblock.free_blocks--;
+        free_extents_count += is_data_block_free(block_index - 1) + is_data_block_free(block_index + 1) - 1;
+        largest_free_extent_valid = 0;
+    }
+
+    //mark the block as used (bit =1) (from the task instructions - bitwise manipulation)
+    block_bitmap_cache[block_index / 8] |= (1 << (block_index % 8));
+    bitmap_cache_dirty = 1;
+
+    if(write_policy_flags & FS_POLICY_LOG_STRUCTURED) {
+        log_head_block = (block_index + 1 < MAX_BLOCKS) ? block_index + 1 : FIRST_DATA_BLOCK;
+    }
+}
+
+void mark_block_as_free(int block_index)
+{
+    if (validate_block_number_and_filesystem(block_index) != 0) {
+        return; 
+    }
+    if (block_index >= FIRST_DATA_BLOCK && !is_data_block_free(block_index)) {
+        // releasing a block creates, extends or merges free extents
+        current_superblock.free_blocks++;
+        free_extents_count += 1 - is_data_block_free(block_index - 1) - is_data_block_free(block_index + 1);
+        largest_free_extent_valid = 0;
+    }
+
+    //mark the block as free (bit =0) from the task instructions - bitwise manipulation)
+    block_bitmap_cache[block_index / 8] &= ~(1 << (block_index % 8));
+    bitmap_cache_dirty = 1;
+}
+
+int validate_block_number_and_filesystem(int i_block_num)
+{
+    if(disk_file_descriptor < 0 || i_block_num < 0 || i_block_num >= MAX_BLOCKS) 
+    {
+        return -1;
+    }
+
+    return 0; // valid block number and filesystem
+}
+
+int read_bitmap_from_disk(unsigned char* i_bitmap_buffer)
+{
+    if(disk_file_descriptor < 0 || i_bitmap_buffer == NULL) 
+    {
+        return -1;
+    }
+
+    lseek(disk_file_descriptor, BLOCK_SIZE, SEEK_SET);
+    int num_of_reading_byte = read(disk_file_descriptor, i_bitmap_buffer, BLOCK_SIZE);
+    if(num_of_reading_byte != BLOCK_SIZE) 
+    {
+        return -1;
+    }
+
+    return 0; 
+}
+
+int write_bitmap_to_disk(const unsigned char* i_bitmap_buffer)
+{
+    if(disk_file_descriptor < 0 || i_bitmap_buffer == NULL) 
+    {
+        return -1;
+    }
+
+    lseek(disk_file_descriptor, BLOCK_SIZE, SEEK_SET);
+    int num_of_writing_byte = write(disk_file_descriptor, i_bitmap_buffer, BLOCK_SIZE);
+    if(num_of_writing_byte != BLOCK_SIZE) 
+    {
+        return -1;
+    }
+
+    return 0; 
+}
+
+int is_data_block_free(int block_index)
+{
+    if (block_index < FIRST_DATA_BLOCK || block_index >= MAX_BLOCKS) {
+        return 0; // metadata and the end of the image bound every extent
+    }
+    return !(block_bitmap_cache[block_index / 8] & (1 << (block_index % 8)));
+}
+
+int find_largest_free_extent()
+{
+    int largest_run = 0;
+    int run_length = 0;
+    for (int block_index = FIRST_DATA_BLOCK; block_index < MAX_BLOCKS; block_index++) {
+        run_length = is_data_block_free(block_index) ? run_length + 1 : 0;
+        if (run_length > largest_run) {
+            largest_run = run_length;
+        }
+    }
+    return largest_run;
+}
+
+void recount_free_space()
+{
+    current_superblock.free_blocks = 0;
+    free_extents_count = 0;
+    for (int block_index = FIRST_DATA_BLOCK; block_index < MAX_BLOCKS; block_index++) {
+        if (!is_data_block_free(block_index)) {
+            continue;
+        }
+        current_superblock.free_blocks++;
+        if (!is_data_block_free(block_index - 1)) {
+            free_extents_count++; // first block of a run
+        }
+    }
+    largest_free_extent = find_largest_free_extent();
+    largest_free_extent_valid = 1;
+
+    current_superblock.free_inodes = free_inode_count;
+}
+
+int flush_bitmap_cache()
+{
+    if(!bitmap_cache_dirty) {
+        return 0; // nothing changed since the last flush
+    }
+
+    if(write_bitmap_to_disk(block_bitmap_cache) != 0) {
+        return -1;
+    }
+
+    bitmap_cache_dirty = 0;
+    return 0;
+}
+
+
+int flush_metadata_caches()
+{
+    if(metadata_flush_deferred > 0) {
+        return 0; // the batch flushes once it is done
+    }
+
+    // every operation ends here, so the image never lags behind a finished operation.
+    // the inode table goes first: a delete cut short between the two writes leaves
+    // blocks marked used that no inode references, never a freed block an inode still uses
+    if(flush_inode_table_cache() < 0) {
+        return -1;
+    }
+    return flush_bitmap_cache();
+}
+
+int flush_inode_table_cache()
+{
+    if(inode_table_dirty_blocks == 0) {
+        return 0; // nothing changed since the last flush
+    }
+
+    // only the dirty blocks are laid out in their on-disk form, from the records that overlap them
+    unsigned char table_block_buffer[BLOCK_SIZE];
+    int result = 0;
+    for(int block = 0; block < INODE_TABLE_BLOCKS && result == 0; block++) {
+        if(!(inode_table_dirty_blocks & (1u << block))) {
+            continue;
+        }
+
+        int block_start = block * BLOCK_SIZE;
+        int first_inode = block_start / (int)sizeof(inode);
+        int last_inode = (block_start + BLOCK_SIZE - 1) / (int)sizeof(inode);
+        if(last_inode >= MAX_FILES) {
+            last_inode = MAX_FILES - 1;
+        }
+        memset(table_block_buffer, 0, BLOCK_SIZE);
+        for(int i = first_inode; i <= last_inode; i++) {
+            // a record can straddle the block boundary, only its part inside this block is copied
+            inode record;
+            read_inode_from_disk(i, &record);
+            int record_start = i * (int)sizeof(inode);
+            int copy_from = (record_start > block_start) ? record_start : block_start;
+            int copy_to = record_start + (int)sizeof(inode);
+            if(copy_to > block_start + BLOCK_SIZE) {
+                copy_to = block_start + BLOCK_SIZE;
+            }
+            memcpy(table_block_buffer + (copy_from - block_start), (char*)&record + (copy_from - record_start), copy_to - copy_from);
+        }
+
+        lseek(disk_file_descriptor, (off_t)(INODE_TABLE_BLOCK + block) * BLOCK_SIZE, SEEK_SET);
+        if(write(disk_file_descriptor, table_block_buffer, BLOCK_SIZE) != BLOCK_SIZE) {
+            result = -1;
+        } else {
+            inode_table_dirty_blocks &= ~(1u << block);
+        }
+    }
+    return result;
+}
+
+transaction_operation* record_transaction_operation(fs_transaction* transaction, const char* filename)
+{
+    // a later operation on the same name replaces the earlier one
+    for(int i = 0; i < transaction->count; i++) {
+        transaction_operation* operation = &transaction->operations[i];
+        if(strcmp(operation->name, filename) == 0) {
+            free(operation->data);
+            operation->data = NULL;
+            operation->size = 0;
+            return operation;
+        }
+    }
+
+    if(transaction->count == transaction->capacity) {
+        int new_capacity = (transaction->capacity > 0) ? transaction->capacity * 2 : 8;
+        transaction_operation* grown = realloc(transaction->operations, new_capacity * sizeof(transaction_operation));
+        if(grown == NULL) {
+            return NULL;
+        }
+        transaction->operations = grown;
+        transaction->capacity = new_capacity;
+    }
+
+    transaction_operation* operation = &transaction->operations[transaction->count++];
+    memset(operation, 0, sizeof(transaction_operation));
+    strncpy(operation->name, filename, MAX_FILENAME);
+    return operation;
+}
+
+int validate_transaction(const fs_transaction* transaction)
+{
+    if(disk_file_descriptor < 0) {
+        return -3; // not mounted
+    }
+
+    // replay the order apply_transaction uses - deletes, shrinking writes, growing writes -
+    // so no step can run out of space once the first change is made
+    int available_blocks = current_superblock.free_blocks - delayed_reserved_blocks;
+    int available_inodes = free_inode_count;
+    for(int i = 0; i < transaction->count; i++) {
+        const transaction_operation* operation = &transaction->operations[i];
+        if(!operation->is_delete) {
+            continue;
+        }
+        if(find_inode_by_name(operation->name) < 0) {
+            return -1; // file not found
+        }
+        inode file_inode;
+        read_inode_from_disk(find_inode_by_name(operation->name), &file_inode);
+        available_blocks += count_file_allocated_blocks(&file_inode);
+        available_inodes++;
+    }
+
+    for(int growing = 0; growing <= 1; growing++) {
+        for(int i = 0; i < transaction->count; i++) {
+            const transaction_operation* operation = &transaction->operations[i];
+            if(operation->is_delete) {
+                continue;
+            }
+            int exists = find_inode_by_name(operation->name) >= 0; // a name is either deleted or written, never both
+            int block_delta = transaction_write_block_delta(operation->name, operation->size);
+            if((block_delta > 0) != growing) {
+                continue;
+            }
+            if(block_delta > available_blocks || (!exists && available_inodes == 0)) {
+                return -2; // the group does not fit
+            }
+            available_blocks -= block_delta;
+            available_inodes -= !exists;
+        }
+    }
+    return 0;
+}
+
+int apply_transaction(const fs_transaction* transaction)
+{
+    // deletes go first so their blocks and inodes are free for the writes
+    for(int i = 0; i < transaction->count; i++) {
+        const transaction_operation* operation = &transaction->operations[i];
+        if(operation->is_delete && release_file_inode(find_inode_by_name(operation->name)) < 0) {
+            return -3;
+        }
+    }
+
+    // shrinking writes release their blocks before any growing write needs them;
+    // each name appears once in a group, so the order between files does not change the result
+    for(int growing = 0; growing <= 1; growing++) {
+        for(int i = 0; i < transaction->count; i++) {
+            const transaction_operation* operation = &transaction->operations[i];
+            if(operation->is_delete) {
+                continue;
+            }
+            if((transaction_write_block_delta(operation->name, operation->size) > 0) != growing) {
+                continue;
+            }
+            int created = find_inode_by_name(operation->name) < 0;
+            if(created && fs_create(operation->name) != 0) {
+                return -3;
+            }
+            if(fs_write(operation->name, operation->data, operation->size) != 0) {
+                if(created) {
+                    release_file_inode(find_inode_by_name(operation->name)); // no empty file is left behind
+                }
+                return -3;
+            }
+        }
+    }
+    return 0;
+}
+
+int transaction_write_block_delta(const char* filename, int size)
+{
+    int new_blocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int inode_index = find_inode_by_name(filename);
+    if(inode_index < 0) {
+        return new_blocks; // a new file allocates everything
+    }
+
+    // the blocks fs_write allocates minus the ones release_blocks_before_rewrite gives back;
+    // both happen inside one fs_write, so only the difference has to fit
+    inode file_inode;
+    read_inode_from_disk(inode_index, &file_inode);
+    if(write_policy_flags & FS_POLICY_LOG_STRUCTURED) {
+        return new_blocks - count_file_allocated_blocks(&file_inode);
+    }
+
+    // in place, old data past the new end is released, a preallocated range stays with the file
+    int old_data_blocks = (file_inode.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int kept_blocks = (new_blocks > inode_preallocated_blocks[inode_index]) ? new_blocks : inode_preallocated_blocks[inode_index];
+    int released_blocks = 0;
+    for(int i = kept_blocks; i < old_data_blocks && i < MAX_DIRECT_BLOCKS; i++) {
+        released_blocks += (file_inode.blocks[i] != 0);
+    }
+    return new_blocks - count_file_allocated_blocks_in_range(&file_inode, new_blocks) - released_blocks;
+}
+
+int write_stream_flush_block(fs_write_stream* stream)
+{
+    if(check_available_space_for_write_operation(1, 0) < 0) {
+        return -2; // not enough space available
+    }
+
+    int block_index = find_free_block();
+    if(block_index < 0) {
+        return -2;
+    }
+
+    lseek(disk_file_descriptor, (off_t)block_index * BLOCK_SIZE, SEEK_SET);
+    if(write(disk_file_descriptor, stream->block_buffer, BLOCK_SIZE) != BLOCK_SIZE) {
+        return -3;
+    }
+
+    mark_block_as_used(block_index);
+    stream->blocks[stream->blocks_written++] = block_index;
+    stream->buffered = 0;
+    return 0;
+}
+
+void write_stream_release(fs_write_stream* stream)
+{
+    for(int i = 0; i < stream->blocks_written; i++) {
+        mark_block_as_free(stream->blocks[i]);
+    }
+    stream->blocks_written = 0;
+}
+
+void detach_open_write_streams()
+{
+    // the caller still owns the streams, they only lose their blocks
+    for(fs_write_stream* stream = open_write_streams; stream != NULL; stream = stream->next_open) {
+        write_stream_release(stream);
+        stream->detached = 1;
+    }
+    open_write_streams = NULL;
+}
+
+int read_stream_fill(fs_read_stream* stream, int file_block)
+{
+    int file_blocks = (stream->size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int first_physical = stream->blocks[file_block];
+
+    // a hole fills one block of zeros, otherwise take the physically consecutive run
+    // a short window keeps random readers from paying for blocks they skip
+    int run_limit = (stream->readahead_blocks < READ_STREAM_BUFFER_BLOCKS) ? stream->readahead_blocks
+                                                                           : READ_STREAM_BUFFER_BLOCKS;
+    int run_blocks = 1;
+    if(first_physical != 0) {
+        while(run_blocks < run_limit && file_block + run_blocks < file_blocks &&
+              stream->blocks[file_block + run_blocks] == first_physical + run_blocks) {
+            run_blocks++;
+        }
+    }
+
+    if(first_physical == 0) {
+        memset(stream->buffer, 0, BLOCK_SIZE);
+    } else {
+        if(first_physical < FIRST_DATA_BLOCK || first_physical + run_blocks > MAX_BLOCKS) {
+            return -3; // invalid block index
+        }
+        ssize_t run_bytes = (ssize_t)run_blocks * BLOCK_SIZE;
+        lseek(disk_file_descriptor, (off_t)first_physical * BLOCK_SIZE, SEEK_SET);
+        if(read(disk_file_descriptor, stream->buffer, run_bytes) != run_bytes) {
+            return -3;
+        }
+    }
+
+    stream->buffer_first_block = file_block;
+    stream->buffer_blocks = run_blocks;
+    return 0;
+}
+
+int read_stream_buffered_bytes(fs_read_stream* stream, const char** chunk)
+{
+    if(disk_file_descriptor < 0 || !inode_is_used(stream->inode_index) ||
+       inode_generations[stream->inode_index] != stream->generation) {
+        return -3; // the file changed under the stream, its blocks may belong to someone else
+    }
+
+    if(stream->position >= stream->size) {
+        return 0; // end of file
+    }
+
+    int file_block = stream->position / BLOCK_SIZE;
+    if(stream->buffer_first_block < 0 || file_block < stream->buffer_first_block ||
+       file_block >= stream->buffer_first_block + stream->buffer_blocks) {
+        if(stream->drop_behind) {
+            read_stream_drop_buffered(stream);
+        }
+        read_stream_adjust_window(stream, file_block);
+        if(read_stream_fill(stream, file_block) < 0) {
+            return -3;
+        }
+        read_stream_prefetch(stream);
+    }
+
+    // from the current position to the end of the buffered run, capped at the file size
+    int buffer_offset = stream->position - stream->buffer_first_block * BLOCK_SIZE;
+    int buffer_end = stream->buffer_blocks * BLOCK_SIZE;
+    int file_end = stream->size - stream->buffer_first_block * BLOCK_SIZE;
+    *chunk = stream->buffer + buffer_offset;
+    return ((buffer_end < file_end) ? buffer_end : file_end) - buffer_offset;
+}
+
+void read_stream_adjust_window(fs_read_stream* stream, int file_block)
+{
+    if(stream->access_pattern != FS_ADVICE_NORMAL) {
+        return; // the caller told us the pattern, the window stays where fs_read_stream_open put it
+    }
+
+    // a refill right after the buffered run (or at the start of the file) continues a sequential read
+    int sequential = (stream->buffer_first_block < 0) ? (file_block == 0)
+                                                      : (file_block == stream->buffer_first_block + stream->buffer_blocks);
+    if(sequential) {
+        stream->readahead_blocks *= 2;
+        if(stream->readahead_blocks > READ_AHEAD_MAX_BLOCKS) {
+            stream->readahead_blocks = READ_AHEAD_MAX_BLOCKS;
+        }
+    } else {
+        stream->readahead_blocks /= 2;
+        if(stream->readahead_blocks < READ_AHEAD_MIN_BLOCKS) {
+            stream->readahead_blocks = READ_AHEAD_MIN_BLOCKS;
+        }
+        stream->prefetched_until = 0; // what was advised ahead of the old position is no longer wanted
+    }
+}
+
+void read_stream_prefetch(fs_read_stream* stream)
+{
+    int file_blocks = (stream->size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int first_block = stream->buffer_first_block + stream->buffer_blocks;
+    if(first_block < stream->prefetched_until) {
+        first_block = stream->prefetched_until;
+    }
+    int end_block = stream->buffer_first_block + stream->buffer_blocks + stream->readahead_blocks;
+    if(end_block > file_blocks) {
+        end_block = file_blocks;
+    }
+
+    // the kernel reads the advised ranges into its page cache while the caller consumes the buffer
+    advise_file_blocks(stream->blocks, first_block, end_block, POSIX_FADV_WILLNEED);
+    if(end_block > stream->prefetched_until) {
+        stream->prefetched_until = end_block;
+    }
+}
+
+void read_stream_drop_buffered(fs_read_stream* stream)
+{
+    if(stream->buffer_first_block >= 0) {
+        advise_file_blocks(stream->blocks, stream->buffer_first_block,
+                           stream->buffer_first_block + stream->buffer_blocks, POSIX_FADV_DONTNEED);
+    }
+}
+
+void advise_file_blocks(const int* blocks, int first_block, int end_block, int advice)
+{
+    // consecutive blocks go out as one range and holes have nothing to advise
+    int block_index = first_block;
+    while(block_index < end_block) {
+        int first_physical = blocks[block_index];
+        int run_blocks = 1;
+        while(block_index + run_blocks < end_block && first_physical != 0 &&
+              blocks[block_index + run_blocks] == first_physical + run_blocks) {
+            run_blocks++;
+        }
+        if(first_physical >= FIRST_DATA_BLOCK && first_physical + run_blocks <= MAX_BLOCKS) {
+            posix_fadvise(disk_file_descriptor, (off_t)first_physical * BLOCK_SIZE, (off_t)run_blocks * BLOCK_SIZE,
+                          advice);
+        }
+        block_index += run_blocks;
+    }
+}
+
+int export_image_range(off_t image_offset, int bytes, int out_fd, int* use_sendfile)
+{
+    // copy_file_range stays inside the kernel (and may share extents) but only between regular files;
+    // sockets and pipes take sendfile, and once one call needed it the rest of the export does too
+    while(bytes > 0) {
+        ssize_t copied;
+        if(!*use_sendfile) {
+            copied = copy_file_range(disk_file_descriptor, &image_offset, out_fd, NULL, bytes, 0);
+            if(copied < 0 && (errno == EINVAL || errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP ||
+                              errno == EBADF)) {
+                *use_sendfile = 1;
+                continue;
+            }
+        } else {
+            copied = sendfile(out_fd, disk_file_descriptor, &image_offset, bytes);
+        }
+        if(copied < 0 && errno == EINTR) {
+            continue;
+        }
+        if(copied <= 0) {
+            return -3; // the image ended early or out_fd refused the data
+        }
+        bytes -= (int)copied; // both calls advance image_offset themselves
+    }
+    return 0;
+}
+
+int export_zeros(int bytes, int out_fd)
+{
+    static const char zero_block[BLOCK_SIZE];
+
+    while(bytes > 0) {
+        int chunk_bytes = (bytes < BLOCK_SIZE) ? bytes : BLOCK_SIZE;
+        ssize_t written = write(out_fd, zero_block, chunk_bytes);
+        if(written < 0 && errno == EINTR) {
+            continue;
+        }
+        if(written <= 0) {
+            return -3;
+        }
+        bytes -= (int)written;
+    }
+    return 0;
+}
+
+void read_inode_from_disk(int i_inode_index, inode* i_inode_buffer)
+{
+    if(disk_file_descriptor < 0 || i_inode_index < 0 || i_inode_index >= MAX_FILES || i_inode_buffer == NULL) 
+    {
+        return; // invalid parameters
+    }
+
+    // the cache holds the current table; the disk catches up at the next flush_metadata_caches
+    memset(i_inode_buffer, 0, sizeof(inode));
+    i_inode_buffer->used = inode_is_used(i_inode_index);
+    memcpy(i_inode_buffer->name, inode_names[i_inode_index], MAX_FILENAME);
+    i_inode_buffer->size = inode_sizes[i_inode_index];
+    memcpy(i_inode_buffer->blocks, inode_block_maps[i_inode_index], sizeof(i_inode_buffer->blocks));
+}
+
+int inode_is_used(int inode_index)
+{
+    return (inode_used_bitmap[inode_index / 8] >> (inode_index % 8)) & 1;
+}
+
+void load_name_slot(char* slot, const char* name)
+{
+    // zero padding makes equal names equal over the whole slot
+    memset(slot, 0, NAME_SLOT_SIZE);
+    strncpy(slot, name, MAX_FILENAME);
+}
+
+int name_slot_equals(const char* slot_a, const char* slot_b)
+{
+    // both slots are aligned and zero padded, so equality is a straight 32-byte compare
+#if defined(__AVX2__)
+    __m256i a = _mm256_load_si256((const __m256i*)slot_a);
+    __m256i b = _mm256_load_si256((const __m256i*)slot_b);
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)) == -1;
+#elif defined(__SSE2__)
+    __m128i low = _mm_cmpeq_epi8(_mm_load_si128((const __m128i*)slot_a), _mm_load_si128((const __m128i*)slot_b));
+    __m128i high = _mm_cmpeq_epi8(_mm_load_si128((const __m128i*)(slot_a + 16)),
+                                  _mm_load_si128((const __m128i*)(slot_b + 16)));
+    return _mm_movemask_epi8(_mm_and_si128(low, high)) == 0xFFFF;
+#else
+    return memcmp(slot_a, slot_b, NAME_SLOT_SIZE) == 0;
+#endif
+}
+
+void store_inode_in_cache(int inode_index, const inode* i_node)
+{
+    if(i_node->used) {
+        inode_used_bitmap[inode_index / 8] |= (1 << (inode_index % 8));
+    } else {
+        inode_used_bitmap[inode_index / 8] &= ~(1 << (inode_index % 8));
+    }
+    load_name_slot(inode_names[inode_index], i_node->name);
+    inode_sizes[inode_index] = i_node->size;
+    memcpy(inode_block_maps[inode_index], i_node->blocks, sizeof(i_node->blocks));
+}
+
+int validate_write_operation_parameters(const char* filename, const void* data, int size) 
+{
+    if(disk_file_descriptor < 0) {
+        return -3; // not mounted
+    }
+
+    if(filename == NULL || data == NULL || size <= 0 || strlen(filename) == 0 || strlen(filename) > MAX_FILENAME) {
+        return -3; // invalid parameters
+    }
+
+    //maximum file size limit is using all the 12 blocks * 4KB = 48KB)
+    if (size > MAX_DIRECT_BLOCKS * BLOCK_SIZE) {
+        return -2; // file too large for the filesystem
+    }
+    
+    return 0; // validation passed
+}
+
+int check_available_space_for_write_operation(int blocks_needed, int current_file_blocks) 
+{
+    // blocks promised to staged delayed writes are not available to anyone else
+    int available_blocks = current_superblock.free_blocks - delayed_reserved_blocks;
+    if (blocks_needed > available_blocks + current_file_blocks) {
+        return -2; // not enough space available
+    }
+    
+    return 0; // enough space
+}
+
+int free_file_existing_blocks(inode* file_inode) 
+{
+    if (file_inode == NULL) {
+        return -3; // invalid parameter
     }
     
-    int old_blocks_count = (file_inode->size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    for (int i = 0; i < old_blocks_count; i++) {
+    // preallocated blocks past the end of the file belong to it as well
+    for (int i = 0; i < MAX_DIRECT_BLOCKS; i++) {
         if (file_inode->blocks[i] != 0 && file_inode->blocks[i] < MAX_BLOCKS) {
             mark_block_as_free(file_inode->blocks[i]);
-            current_superblock.free_blocks++;
             file_inode->blocks[i] = 0; // clear the pointer
         }
         
@@ -585,28 +2614,76 @@ int free_file_existing_blocks(inode* file_inode)
     return 0;
 }
 
+int count_file_allocated_blocks(const inode* file_inode)
+{
+    return count_file_allocated_blocks_in_range(file_inode, MAX_DIRECT_BLOCKS);
+}
+
+int count_file_allocated_blocks_in_range(const inode* file_inode, int blocks_count)
+{
+    int allocated_blocks = 0;
+    for (int i = 0; i < blocks_count && i < MAX_DIRECT_BLOCKS; i++) {
+        if (file_inode->blocks[i] != 0) {
+            allocated_blocks++;
+        }
+    }
+    return allocated_blocks;
+}
+
+int release_blocks_before_rewrite(int inode_index, inode* file_inode, int blocks_needed)
+{
+    if (file_inode == NULL) {
+        return -3;
+    }
+
+    if (write_policy_flags & FS_POLICY_LOG_STRUCTURED) {
+        // never overwrite in place - the new copy goes to the log head
+        inode_preallocated_blocks[inode_index] = 0;
+        return free_file_existing_blocks(file_inode);
+    }
+
+    // old data past the new end goes away, a preallocated tail and the range fs_fallocate
+    // covered stay with the file
+    int old_data_blocks = (file_inode->size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int kept_blocks = (blocks_needed > inode_preallocated_blocks[inode_index]) ? blocks_needed : inode_preallocated_blocks[inode_index];
+    for (int i = kept_blocks; i < old_data_blocks; i++) {
+        if (file_inode->blocks[i] != 0 && file_inode->blocks[i] < MAX_BLOCKS) {
+            mark_block_as_free(file_inode->blocks[i]);
+            file_inode->blocks[i] = 0;
+        }
+    }
+    return 0;
+}
+
 int allocate_blocks_for_file(inode* file_inode, int blocks_needed) 
 {
     if (file_inode == NULL || blocks_needed <= 0) {
         return -3; 
     }
     
-    //allocate the new blocks we need
+    int allocated_in_this_call[MAX_DIRECT_BLOCKS];
+    int allocated_count = 0;
+
+    //allocate the new blocks we need, blocks the file already owns are kept as they are
     for (int block_iterator = 0; block_iterator < blocks_needed; block_iterator++) {
+        if (file_inode->blocks[block_iterator] != 0) {
+            continue;
+        }
+
         int new_block_number = find_free_block();
         if (new_block_number < 0) { //we didnt find a free block while we allready allocated some blocks
-            //we need to free the blocks we already allocated
-            for (int rollback_iterator = 0; rollback_iterator < block_iterator; rollback_iterator++) {
-                mark_block_as_free(file_inode->blocks[rollback_iterator]);
-                current_superblock.free_blocks++;
-                file_inode->blocks[rollback_iterator] = 0;
+            //we need to free the blocks we allocated in this call
+            for (int rollback_iterator = 0; rollback_iterator < allocated_count; rollback_iterator++) {
+                int rollback_index = allocated_in_this_call[rollback_iterator];
+                mark_block_as_free(file_inode->blocks[rollback_index]);
+                file_inode->blocks[rollback_index] = 0;
             }
             return -2; // allocation failed
         }
         
+        allocated_in_this_call[allocated_count++] = block_iterator;
         mark_block_as_used(new_block_number);
         file_inode->blocks[block_iterator] = new_block_number;
-        current_superblock.free_blocks--;
     }
     
     return 0; // success
@@ -620,29 +2697,280 @@ int write_data_to_allocated_blocks(inode* file_inode, const void* data, int size
     }
     
     const char* data_bytes = (const char*)data;
-    int bytes_written = 0;
+    char tail_block_buffer[BLOCK_SIZE];
+    int block_iterator = 0;
     
-    for (int block_iterator = 0; block_iterator < blocks_needed; block_iterator++) {
-        int block_number = file_inode->blocks[block_iterator];
-        
-        // Calculate bytes to write in this block
-        int bytes_to_write_in_this_block = (size - bytes_written > BLOCK_SIZE) ? BLOCK_SIZE : (size - bytes_written);
-        
-        char block_buffer[BLOCK_SIZE];
-        memset(block_buffer, 0, BLOCK_SIZE);  //adding 0 for partial blocks
-        //copy data to buffer
-        memcpy(block_buffer, data_bytes + bytes_written, bytes_to_write_in_this_block);
-        
-        //write block to disk
-        off_t block_position = block_number * BLOCK_SIZE;
-        lseek(disk_file_descriptor, block_position, SEEK_SET);
-        if (write(disk_file_descriptor, block_buffer, BLOCK_SIZE) != BLOCK_SIZE) {
+    // blocks that are physically consecutive go out in a single writev call, so a
+    // sequentially allocated file costs one seek and one write instead of one per block
+    while (block_iterator < blocks_needed) {
+        int run_length = 1;
+        while (block_iterator + run_length < blocks_needed &&
+               file_inode->blocks[block_iterator + run_length] == file_inode->blocks[block_iterator] + run_length) {
+            run_length++;
+        }
+
+        // only the last block of the file can be partial
+        int run_offset = block_iterator * BLOCK_SIZE;
+        int run_bytes = (size - run_offset > run_length * BLOCK_SIZE) ? run_length * BLOCK_SIZE : (size - run_offset);
+        int full_blocks_bytes = (run_bytes / BLOCK_SIZE) * BLOCK_SIZE;
+        int tail_bytes = run_bytes - full_blocks_bytes;
+
+        struct iovec run_vectors[2];
+        int vectors_count = 0;
+        if (full_blocks_bytes > 0) {
+            run_vectors[vectors_count].iov_base = (void*)(data_bytes + run_offset);
+            run_vectors[vectors_count].iov_len = full_blocks_bytes;
+            vectors_count++;
+        }
+        if (tail_bytes > 0) {
+            memset(tail_block_buffer, 0, BLOCK_SIZE);  //adding 0 for partial blocks
+            memcpy(tail_block_buffer, data_bytes + run_offset + full_blocks_bytes, tail_bytes);
+            run_vectors[vectors_count].iov_base = tail_block_buffer;
+            run_vectors[vectors_count].iov_len = BLOCK_SIZE;
+            vectors_count++;
+        }
+
+        //write the whole run to disk
+        off_t run_position = (off_t)file_inode->blocks[block_iterator] * BLOCK_SIZE;
+        lseek(disk_file_descriptor, run_position, SEEK_SET);
+        if (writev(disk_file_descriptor, run_vectors, vectors_count) != run_length * BLOCK_SIZE) {
             return -3; //other error
         }
-        
-        bytes_written += bytes_to_write_in_this_block;
+
+        block_iterator += run_length;
     }
     
     return 0;
 }
-    
\ No newline at end of file
+
+int find_free_block_run(int blocks_count)
+{
+    if (blocks_count <= 0 || validate_block_number_and_filesystem(0) != 0) {
+        return -1;
+    }
+
+    // same starting point as find_free_block, but a run never wraps past the end of
+    // the image: first search from the start point, then the part before it
+    int start_block = (write_policy_flags & FS_POLICY_LOG_STRUCTURED) ? log_head_block : FIRST_DATA_BLOCK;
+    int search_ranges[2][2] = {
+        {start_block, MAX_BLOCKS},
+        {FIRST_DATA_BLOCK, (start_block + blocks_count - 1 < MAX_BLOCKS) ? start_block + blocks_count - 1 : MAX_BLOCKS}
+    };
+    int passes_count = (start_block > FIRST_DATA_BLOCK) ? 2 : 1;
+
+    for (int pass = 0; pass < passes_count; pass++) {
+        int run_length = 0;
+        for (int block_index = search_ranges[pass][0]; block_index < search_ranges[pass][1]; block_index++) {
+            if (block_bitmap_cache[block_index / 8] & (1 << (block_index % 8))) {
+                run_length = 0;
+                continue;
+            }
+            if (++run_length == blocks_count) {
+                return block_index - blocks_count + 1;
+            }
+        }
+    }
+    return -1; // free space is too fragmented for a single run
+}
+
+int allocate_contiguous_blocks_for_file(inode* file_inode, int blocks_needed)
+{
+    if (file_inode == NULL || blocks_needed <= 0) {
+        return -3;
+    }
+
+    int missing_blocks = blocks_needed - count_file_allocated_blocks_in_range(file_inode, blocks_needed);
+    if (missing_blocks == 0) {
+        return 0; // everything is allocated already
+    }
+
+    int run_start = find_free_block_run(missing_blocks);
+    if (run_start < 0) {
+        return allocate_blocks_for_file(file_inode, blocks_needed); // fall back to block by block
+    }
+
+    // the run fills the holes in file order
+    for (int block_iterator = 0; block_iterator < blocks_needed; block_iterator++) {
+        if (file_inode->blocks[block_iterator] != 0) {
+            continue;
+        }
+        mark_block_as_used(run_start);
+        file_inode->blocks[block_iterator] = run_start++;
+    }
+    return 0;
+}
+
+int find_delayed_write_slot(int inode_index)
+{
+    for (int slot_index = 0; slot_index < DELAYED_WRITE_SLOTS; slot_index++) {
+        if (delayed_writes[slot_index].used && delayed_writes[slot_index].inode_index == inode_index) {
+            return slot_index;
+        }
+    }
+    return -1; // nothing staged for this inode
+}
+
+int stage_delayed_write(int inode_index, int slot_index, const void* data, int size, int blocks_needed)
+{
+    for (int free_index = 0; slot_index < 0 && free_index < DELAYED_WRITE_SLOTS; free_index++) {
+        if (!delayed_writes[free_index].used) {
+            slot_index = free_index;
+        }
+    }
+    if (slot_index < 0) {
+        // every slot is taken - make room by flushing one of them to disk
+        slot_index = delayed_eviction_cursor;
+        delayed_eviction_cursor = (delayed_eviction_cursor + 1) % DELAYED_WRITE_SLOTS;
+        if (flush_delayed_write(slot_index) < 0) {
+            return -3;
+        }
+    }
+
+    delayed_write* slot = &delayed_writes[slot_index];
+
+    // only a block count is reserved now, the physical blocks are chosen at flush time.
+    // an in-place flush reuses the blocks the file already has inside its new size, so only
+    // the missing ones are reserved; the log never overwrites, so there every block is new
+    int reserved_blocks = blocks_needed;
+    if (!(write_policy_flags & FS_POLICY_LOG_STRUCTURED)) {
+        inode file_inode;
+        read_inode_from_disk(inode_index, &file_inode);
+        reserved_blocks -= count_file_allocated_blocks_in_range(&file_inode, blocks_needed);
+    }
+    if (reserved_blocks - slot->reserved_blocks > current_superblock.free_blocks - delayed_reserved_blocks) {
+        return -2; // not enough space available
+    }
+
+    char* staged_data = realloc(slot->data, size);
+    if (staged_data == NULL) {
+        return -3; // out of memory
+    }
+    memcpy(staged_data, data, size);
+
+    delayed_reserved_blocks += reserved_blocks - slot->reserved_blocks;
+    inode_generations[inode_index] = ++generation_clock; // the inode itself is written at flush time
+    slot->used = 1;
+    slot->inode_index = inode_index;
+    slot->size = size;
+    slot->blocks_needed = blocks_needed;
+    slot->reserved_blocks = reserved_blocks;
+    slot->data = staged_data;
+    return 0;
+}
+
+int flush_delayed_write(int slot_index)
+{
+    delayed_write* slot = &delayed_writes[slot_index];
+    if (!slot->used || disk_file_descriptor < 0) {
+        return 0; // free slot
+    }
+
+    inode file_inode;
+    read_inode_from_disk(slot->inode_index, &file_inode);
+
+    // the new copy is written before the inode lets go of any old block, so a failed
+    // flush leaves the file, the bitmap and the staged data (reservation included) as they were.
+    // in place the blocks inside the new size are reused, the log gets a fresh set
+    inode flushed_inode = file_inode;
+    int log_structured = write_policy_flags & FS_POLICY_LOG_STRUCTURED;
+    if (log_structured) {
+        memset(flushed_inode.blocks, 0, sizeof(flushed_inode.blocks));
+    }
+    int result = 0;
+    if (slot->blocks_needed > 0) {
+        result = allocate_contiguous_blocks_for_file(&flushed_inode, slot->blocks_needed);
+    }
+    if (result == 0) {
+        result = write_data_to_allocated_blocks(&flushed_inode, slot->data, slot->size, slot->blocks_needed);
+        if (result < 0) {
+            // give back what this flush allocated, the old blocks never left the file
+            for (int i = 0; i < slot->blocks_needed; i++) {
+                if (flushed_inode.blocks[i] != 0 && flushed_inode.blocks[i] != file_inode.blocks[i]) {
+                    mark_block_as_free(flushed_inode.blocks[i]);
+                }
+            }
+        }
+    }
+    if (result < 0) {
+        flush_metadata_caches();
+        return -3;
+    }
+
+    // only now do the old blocks go back: all of them in the log, old data past the new end in place
+    if (log_structured) {
+        free_file_existing_blocks(&file_inode);
+        inode_preallocated_blocks[slot->inode_index] = 0;
+    } else {
+        release_blocks_before_rewrite(slot->inode_index, &flushed_inode, slot->blocks_needed);
+    }
+    flushed_inode.size = slot->size;
+    write_inode_to_disk(slot->inode_index, &flushed_inode);
+    flush_metadata_caches();
+
+    delayed_reserved_blocks -= slot->reserved_blocks;
+    free(slot->data);
+    memset(slot, 0, sizeof(delayed_write));
+    return 0;
+}
+
+int build_directory_prefix(const char* path, char* prefix_buffer)
+{
+    // "" is the top level, "a/b" becomes "a/b/" - the name of its marker and the prefix of its entries
+    if(path == NULL) {
+        return -1;
+    }
+
+    int path_length = strlen(path);
+    if(path_length == 0) {
+        prefix_buffer[0] = '\0';
+        return 0;
+    }
+
+    // the stored name keeps at most MAX_FILENAME - 1 characters, the '/' included
+    if(path_length + 1 > MAX_FILENAME - 1 || path[0] == '/' || path[path_length - 1] == '/' ||
+       strstr(path, "//") != NULL) {
+        return -1;
+    }
+
+    memcpy(prefix_buffer, path, path_length);
+    prefix_buffer[path_length] = '/';
+    prefix_buffer[path_length + 1] = '\0';
+    return 0;
+}
+
+int zero_file_blocks(const inode* file_inode, int first_block, int blocks_count)
+{
+    static const char zero_block_buffer[BLOCK_SIZE] = {0};
+
+    for (int block_iterator = first_block; block_iterator < first_block + blocks_count; block_iterator++) {
+        int block_number = file_inode->blocks[block_iterator];
+        if (block_number == 0) {
+            continue; // a hole reads as zeros anyway
+        }
+
+        lseek(disk_file_descriptor, (off_t)block_number * BLOCK_SIZE, SEEK_SET);
+        if (write(disk_file_descriptor, zero_block_buffer, BLOCK_SIZE) != BLOCK_SIZE) {
+            return -3;
+        }
+    }
+    return 0;
+}
+
+int flush_all_delayed_writes()
+{
+    int result = 0;
+    for (int slot_index = 0; slot_index < DELAYED_WRITE_SLOTS; slot_index++) {
+        if (flush_delayed_write(slot_index) < 0) {
+            result = -3;
+        }
+    }
+    return result;
+}
+
+void discard_delayed_write(int slot_index)
+{
+    delayed_write* slot = &delayed_writes[slot_index];
+    delayed_reserved_blocks -= slot->reserved_blocks;
+    free(slot->data);
+    memset(slot, 0, sizeof(delayed_write));
+}
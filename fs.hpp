@@ -0,0 +1,285 @@
+/**
+ * @file fs.hpp
+ * @brief C++20 RAII wrapper for the OnlyFiles filesystem
+ *
+ * onlyfiles::filesystem owns the mount and unmounts when it goes out of
+ * scope. Reads and writes take std::span buffers and names are
+ * std::string_view; a name is copied once onto the stack to terminate it,
+ * data is never copied. Listings are ranges that page through fs_list_next,
+ * fs_list_prefix and fs_list_dir and hand out views of the cached names.
+ *
+ * Every call is an inline forward to the C API and returns the same codes.
+ * Header-only; link with fs.c.
+ */
+
+#ifndef FS_HPP
+#define FS_HPP
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "fs_ext.h"
+
+namespace onlyfiles {
+
+namespace detail {
+
+// A file name terminated on the stack; names longer than the filesystem accepts are marked invalid
+class name_buffer {
+public:
+    name_buffer() noexcept = default;
+
+    explicit name_buffer(std::string_view name) noexcept {
+        if (name.size() <= MAX_FILENAME) {
+            std::copy_n(name.data(), name.size(), text_); // an empty view may carry a null data()
+            text_[name.size()] = '\0';
+            valid_ = true;
+        }
+    }
+
+    bool valid() const noexcept { return valid_; }
+    const char* c_str() const noexcept { return text_; }
+    std::string_view view() const noexcept { return std::string_view(text_); }
+
+private:
+    char text_[MAX_FILENAME + 1] = {};
+    bool valid_ = false;
+};
+
+// fs_read/fs_write take int sizes
+inline bool fits_int(std::size_t size) noexcept { return size <= static_cast<std::size_t>(INT_MAX); }
+
+} // namespace detail
+
+/** @brief One listed file; name views the inode cache and follows the fs_list_next lifetime rules */
+struct dir_entry {
+    std::string_view name;
+    int size;
+};
+
+/**
+ * @brief Single-pass range over a listing, fetched page by page
+ *
+ * Iterate it once, for example with a range-for. A listing that fails with
+ * an error simply ends.
+ */
+class listing {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = dir_entry;
+        using difference_type = std::ptrdiff_t;
+        using reference = const dir_entry&;
+        using pointer = const dir_entry*;
+
+        iterator() noexcept = default;
+        explicit iterator(listing* owner) noexcept : owner_(owner) {}
+
+        reference operator*() const noexcept { return owner_->current_; }
+        pointer operator->() const noexcept { return &owner_->current_; }
+        iterator& operator++() {
+            owner_->advance();
+            return *this;
+        }
+        void operator++(int) { owner_->advance(); }
+        friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept { return it.at_end(); }
+
+    private:
+        bool at_end() const noexcept { return owner_->at_end(); }
+
+        listing* owner_ = nullptr;
+    };
+
+    iterator begin() {
+        if (!started_) {
+            started_ = true;
+            advance();
+        }
+        return iterator(this);
+    }
+    std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+    friend class filesystem;
+
+    enum class kind { all, prefix, directory };
+
+    static constexpr int page_size = 32;
+
+    listing(kind listing_kind, std::string_view filter) noexcept
+        : kind_(listing_kind), filter_(filter), finished_(!filter_.valid()) {}
+
+    bool at_end() const noexcept { return !has_current_; }
+
+    void advance() {
+        if (index_ >= count_ && !finished_) {
+            fetch_page();
+        }
+        has_current_ = index_ < count_;
+        if (has_current_) {
+            current_ = dir_entry{std::string_view(page_[index_].name), page_[index_].size};
+            index_++;
+        }
+    }
+
+    void fetch_page() {
+        int fetched;
+        switch (kind_) {
+            case kind::prefix:
+                fetched = fs_list_prefix(filter_.c_str(), &cursor_, page_, page_size);
+                break;
+            case kind::directory:
+                fetched = fs_list_dir(filter_.c_str(), &cursor_, page_, page_size);
+                break;
+            default:
+                fetched = fs_list_next(&cursor_, page_, page_size);
+                break;
+        }
+        count_ = (fetched > 0) ? fetched : 0;
+        index_ = 0;
+        finished_ = fetched < page_size; // a short page is the last one
+    }
+
+    kind kind_;
+    detail::name_buffer filter_;
+    fs_list_cursor cursor_ = FS_LIST_CURSOR_INIT;
+    fs_dirent page_[page_size] = {};
+    dir_entry current_{};
+    int count_ = 0;
+    int index_ = 0;
+    bool started_ = false;
+    bool has_current_ = false;
+    bool finished_;
+};
+
+/**
+ * @brief A file of the mounted filesystem, addressed by name
+ *
+ * Holds only the name; every call goes to the filesystem that is mounted at
+ * the time.
+ */
+class file {
+public:
+    explicit file(std::string_view name) noexcept : name_(name) {}
+
+    std::string_view name() const noexcept { return name_.view(); }
+
+    /** @brief fs_read into buffer; returns bytes read or the fs_read error */
+    int read(std::span<std::byte> buffer) const noexcept {
+        if (!name_.valid() || !detail::fits_int(buffer.size())) {
+            return -3;
+        }
+        return fs_read(name_.c_str(), buffer.data(), static_cast<int>(buffer.size()));
+    }
+    int read(std::span<char> buffer) const noexcept { return read(std::as_writable_bytes(buffer)); }
+
+    /** @brief fs_write of the whole file contents */
+    int write(std::span<const std::byte> data) const noexcept {
+        if (!name_.valid() || !detail::fits_int(data.size())) {
+            return -3;
+        }
+        return fs_write(name_.c_str(), data.data(), static_cast<int>(data.size()));
+    }
+    int write(std::string_view text) const noexcept { return write(std::as_bytes(std::span(text))); }
+
+    int stat(fs_file_stat& stat_buffer) const noexcept {
+        return name_.valid() ? fs_stat(name_.c_str(), &stat_buffer) : -3;
+    }
+    int truncate(int new_size) const noexcept { return name_.valid() ? fs_truncate(name_.c_str(), new_size) : -3; }
+
+    /** @brief 1 if the file exists, 0 if not, -3 for an invalid name or when not mounted */
+    int exists() const noexcept { return name_.valid() ? fs_exists(name_.c_str()) : -3; }
+
+private:
+    detail::name_buffer name_;
+};
+
+/**
+ * @brief Owns the mount of a disk image
+ *
+ * Only one image can be mounted per process, so at most one filesystem
+ * object is mounted at a time. Moving transfers the mount.
+ */
+class filesystem {
+public:
+    static int format(const std::string& disk_path) noexcept { return fs_format(disk_path.c_str()); }
+
+    filesystem() noexcept = default;
+    explicit filesystem(const std::string& disk_path) noexcept : mounted_(fs_mount(disk_path.c_str()) == 0) {}
+    filesystem(filesystem&& other) noexcept : mounted_(std::exchange(other.mounted_, false)) {}
+    filesystem& operator=(filesystem&& other) noexcept {
+        if (this != &other) {
+            unmount();
+            mounted_ = std::exchange(other.mounted_, false);
+        }
+        return *this;
+    }
+    filesystem(const filesystem&) = delete;
+    filesystem& operator=(const filesystem&) = delete;
+    ~filesystem() { unmount(); }
+
+    bool is_mounted() const noexcept { return mounted_; }
+    explicit operator bool() const noexcept { return mounted_; }
+
+    void unmount() noexcept {
+        if (mounted_) {
+            fs_unmount();
+            mounted_ = false;
+        }
+    }
+
+    int sync() const noexcept { return fs_sync(); }
+
+    int create(std::string_view name) const noexcept {
+        detail::name_buffer terminated(name);
+        return terminated.valid() ? fs_create(terminated.c_str()) : -3;
+    }
+
+    int remove(std::string_view name) const noexcept {
+        detail::name_buffer terminated(name);
+        return terminated.valid() ? fs_delete(terminated.c_str()) : -2;
+    }
+
+    int rename(std::string_view old_name, std::string_view new_name) const noexcept {
+        detail::name_buffer from(old_name);
+        detail::name_buffer to(new_name);
+        return (from.valid() && to.valid()) ? fs_rename(from.c_str(), to.c_str()) : -3;
+    }
+
+    int mkdir(std::string_view path) const noexcept {
+        detail::name_buffer terminated(path);
+        return terminated.valid() ? fs_mkdir(terminated.c_str()) : -3;
+    }
+
+    int statfs(fs_statfs_info& info) const noexcept { return fs_statfs(&info); }
+
+    file open(std::string_view name) const noexcept { return file(name); }
+
+    int read(std::string_view name, std::span<std::byte> buffer) const noexcept { return file(name).read(buffer); }
+    int read(std::string_view name, std::span<char> buffer) const noexcept { return file(name).read(buffer); }
+    int write(std::string_view name, std::span<const std::byte> data) const noexcept { return file(name).write(data); }
+    int write(std::string_view name, std::string_view text) const noexcept { return file(name).write(text); }
+
+    /** @brief Every file, in inode order */
+    listing list() const noexcept { return listing(listing::kind::all, {}); }
+
+    /** @brief Files whose names start with prefix, in name order */
+    listing list_prefix(std::string_view prefix) const noexcept { return listing(listing::kind::prefix, prefix); }
+
+    /** @brief Direct children of a directory ("" for the top level), in name order */
+    listing list_dir(std::string_view path) const noexcept { return listing(listing::kind::directory, path); }
+
+private:
+    bool mounted_ = false;
+};
+
+} // namespace onlyfiles
+
+#endif /* FS_HPP */
@@ -0,0 +1,281 @@
+#include "fs_async.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// global vars
+static pthread_mutex_t fs_mutex = PTHREAD_MUTEX_INITIALIZER; // held around every fs_* call of the workers
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER; // guards everything below
+static pthread_cond_t queue_not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t queue_idle = PTHREAD_COND_INITIALIZER; // signalled when in_flight drops to 0
+static fs_async_request* pending_head = NULL;
+static fs_async_request* pending_tail = NULL;
+static fs_async_request* completed_head = NULL; // finished requests without a callback
+static fs_async_request* completed_tail = NULL;
+static int in_flight = 0; // submitted and not yet completed
+static pthread_t workers[FS_ASYNC_MAX_WORKERS];
+static int running_workers = 0;
+static int stopping = 0;
+static int completion_eventfd = -1;
+
+// #### helper functions declaration #####
+void* async_worker_main(void* unused);
+int execute_async_request(const fs_async_request* request);
+void complete_async_request(fs_async_request* request);
+
+
+int fs_async_start(int worker_count, int event_fd)
+{
+    if(worker_count < 1 || worker_count > FS_ASYNC_MAX_WORKERS) {
+        return -3; // invalid parameters
+    }
+
+    pthread_mutex_lock(&queue_mutex);
+    if(running_workers > 0) {
+        pthread_mutex_unlock(&queue_mutex);
+        return -3; // already started
+    }
+    stopping = 0;
+    completion_eventfd = event_fd;
+    for(int i = 0; i < worker_count; i++) {
+        if(pthread_create(&workers[i], NULL, async_worker_main, NULL) != 0) {
+            break;
+        }
+        running_workers++;
+    }
+    int started = running_workers;
+    pthread_mutex_unlock(&queue_mutex);
+
+    if(started < worker_count) {
+        fs_async_stop(); // a partial pool is not what the caller asked for
+        return -3;
+    }
+    return 0;
+}
+
+void fs_async_stop(void)
+{
+    pthread_mutex_lock(&queue_mutex);
+    int worker_count = running_workers;
+    stopping = 1;
+    pthread_cond_broadcast(&queue_not_empty);
+    pthread_mutex_unlock(&queue_mutex);
+
+    // workers only leave once the pending queue is empty
+    for(int i = 0; i < worker_count; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    pthread_mutex_lock(&queue_mutex);
+    running_workers = 0;
+    stopping = 0;
+    completion_eventfd = -1;
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+int fs_async_submit(fs_async_request* request)
+{
+    if(request == NULL || request->opcode < FS_ASYNC_READ || request->opcode > FS_ASYNC_DELETE ||
+       request->filename == NULL) {
+        return -3; // invalid parameters
+    }
+
+    pthread_mutex_lock(&queue_mutex);
+    if(running_workers == 0 || stopping) {
+        pthread_mutex_unlock(&queue_mutex);
+        return -3; // the pool is not running
+    }
+
+    request->next = NULL;
+    if(pending_tail != NULL) {
+        pending_tail->next = request;
+    } else {
+        pending_head = request;
+    }
+    pending_tail = request;
+    in_flight++;
+    pthread_cond_signal(&queue_not_empty);
+    pthread_mutex_unlock(&queue_mutex);
+    return 0;
+}
+
+int fs_async_read(fs_async_request* request, const char* filename, void* buffer, int size,
+                  fs_async_callback callback, void* user_data)
+{
+    if(request == NULL) {
+        return -3;
+    }
+
+    request->opcode = FS_ASYNC_READ;
+    request->filename = filename;
+    request->buffer = buffer;
+    request->data = NULL;
+    request->size = size;
+    request->callback = callback;
+    request->user_data = user_data;
+    return fs_async_submit(request);
+}
+
+int fs_async_write(fs_async_request* request, const char* filename, const void* data, int size,
+                   fs_async_callback callback, void* user_data)
+{
+    if(request == NULL) {
+        return -3;
+    }
+
+    request->opcode = FS_ASYNC_WRITE;
+    request->filename = filename;
+    request->buffer = NULL;
+    request->data = data;
+    request->size = size;
+    request->callback = callback;
+    request->user_data = user_data;
+    return fs_async_submit(request);
+}
+
+int fs_async_create(fs_async_request* request, const char* filename, fs_async_callback callback, void* user_data)
+{
+    if(request == NULL) {
+        return -3;
+    }
+
+    request->opcode = FS_ASYNC_CREATE;
+    request->filename = filename;
+    request->buffer = NULL;
+    request->data = NULL;
+    request->size = 0;
+    request->callback = callback;
+    request->user_data = user_data;
+    return fs_async_submit(request);
+}
+
+int fs_async_delete(fs_async_request* request, const char* filename, fs_async_callback callback, void* user_data)
+{
+    if(request == NULL) {
+        return -3;
+    }
+
+    request->opcode = FS_ASYNC_DELETE;
+    request->filename = filename;
+    request->buffer = NULL;
+    request->data = NULL;
+    request->size = 0;
+    request->callback = callback;
+    request->user_data = user_data;
+    return fs_async_submit(request);
+}
+
+int fs_async_reap(fs_async_request** completed, int max_requests)
+{
+    if(completed == NULL || max_requests < 0) {
+        return -3; // invalid parameters
+    }
+
+    int reaped = 0;
+    pthread_mutex_lock(&queue_mutex);
+    while(completed_head != NULL && reaped < max_requests) {
+        completed[reaped++] = completed_head;
+        completed_head = completed_head->next;
+    }
+    if(completed_head == NULL) {
+        completed_tail = NULL;
+    }
+    pthread_mutex_unlock(&queue_mutex);
+    return reaped;
+}
+
+void fs_async_drain(void)
+{
+    pthread_mutex_lock(&queue_mutex);
+    while(in_flight > 0) {
+        pthread_cond_wait(&queue_idle, &queue_mutex);
+    }
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+void fs_async_lock(void)
+{
+    pthread_mutex_lock(&fs_mutex);
+}
+
+void fs_async_unlock(void)
+{
+    pthread_mutex_unlock(&fs_mutex);
+}
+
+
+// #### helper functions #####
+void* async_worker_main(void* unused)
+{
+    (void)unused;
+
+    for(;;) {
+        pthread_mutex_lock(&queue_mutex);
+        while(pending_head == NULL && !stopping) {
+            pthread_cond_wait(&queue_not_empty, &queue_mutex);
+        }
+        fs_async_request* request = pending_head;
+        if(request == NULL) {
+            pthread_mutex_unlock(&queue_mutex);
+            return NULL; // stopping and nothing left to do
+        }
+        pending_head = request->next;
+        if(pending_head == NULL) {
+            pending_tail = NULL;
+        }
+        pthread_mutex_unlock(&queue_mutex);
+
+        // the filesystem keeps global state, so only one worker may be inside it
+        pthread_mutex_lock(&fs_mutex);
+        request->result = execute_async_request(request);
+        pthread_mutex_unlock(&fs_mutex);
+
+        complete_async_request(request);
+    }
+}
+
+int execute_async_request(const fs_async_request* request)
+{
+    switch(request->opcode) {
+        case FS_ASYNC_READ:
+            return fs_read(request->filename, request->buffer, request->size);
+        case FS_ASYNC_WRITE:
+            return fs_write(request->filename, request->data, request->size);
+        case FS_ASYNC_CREATE:
+            return fs_create(request->filename);
+        case FS_ASYNC_DELETE:
+            return fs_delete(request->filename);
+        default:
+            return -3;
+    }
+}
+
+void complete_async_request(fs_async_request* request)
+{
+    // read the eventfd before the request is handed back - the caller may reuse it right away
+    int event_fd = completion_eventfd;
+
+    if(request->callback != NULL) {
+        request->callback(request);
+        pthread_mutex_lock(&queue_mutex);
+    } else {
+        pthread_mutex_lock(&queue_mutex);
+        request->next = NULL;
+        if(completed_tail != NULL) {
+            completed_tail->next = request;
+        } else {
+            completed_head = request;
+        }
+        completed_tail = request;
+    }
+    if(--in_flight == 0) {
+        pthread_cond_broadcast(&queue_idle);
+    }
+    pthread_mutex_unlock(&queue_mutex);
+
+    // a failed signal loses nothing: the request is already on the queue or called back
+    if(event_fd >= 0) {
+        uint64_t one = 1;
+        write(event_fd, &one, sizeof(one));
+    }
+}
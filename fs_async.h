@@ -0,0 +1,146 @@
+/**
+ * @file fs_async.h
+ * @brief Asynchronous read/write/create/delete for the OnlyFiles filesystem
+ *
+ * Requests are queued to a pool of worker threads that run the matching fs_*
+ * call and then report completion through a callback, a completion queue and
+ * an optional eventfd. One event loop thread can keep many requests in flight
+ * without blocking on any of them.
+ *
+ * The filesystem itself is single-threaded, so the workers serialize every
+ * fs_* call behind one mutex; the pool overlaps completion handling with the
+ * next operation. Synchronous fs_* calls made while requests are in flight
+ * must be bracketed by fs_async_lock/fs_async_unlock.
+ *
+ * Build with fs_async.c and -pthread.
+ */
+
+#ifndef FS_ASYNC_H
+#define FS_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fs.h"
+
+#define FS_ASYNC_READ 1    /**< fs_read(filename, buffer, size) */
+#define FS_ASYNC_WRITE 2   /**< fs_write(filename, data, size) */
+#define FS_ASYNC_CREATE 3  /**< fs_create(filename) */
+#define FS_ASYNC_DELETE 4  /**< fs_delete(filename) */
+
+/** Maximum number of worker threads fs_async_start accepts */
+#define FS_ASYNC_MAX_WORKERS 16
+
+struct fs_async_request;
+
+/**
+ * @brief Called on a worker thread when a request completes
+ *
+ * The request may be reused or released from inside the callback.
+ */
+typedef void (*fs_async_callback)(struct fs_async_request* request);
+
+/**
+ * @brief One asynchronous operation, owned by the caller
+ *
+ * The request, its file name and its buffer must stay valid until the request
+ * completes. The engine never allocates per request.
+ */
+typedef struct fs_async_request {
+    int opcode;                  /**< FS_ASYNC_* operation */
+    const char* filename;        /**< Name of the file */
+    void* buffer;                /**< Destination of FS_ASYNC_READ */
+    const void* data;            /**< Source of FS_ASYNC_WRITE */
+    int size;                    /**< Bytes to read or write */
+    int result;                  /**< Return value of the fs_* call, set on completion */
+    fs_async_callback callback;  /**< Completion callback, or NULL to use the completion queue */
+    void* user_data;             /**< Free for the caller */
+    struct fs_async_request* next; /**< Internal queue link */
+} fs_async_request;
+
+/**
+ * @brief Starts the worker pool
+ *
+ * @param worker_count Number of worker threads, 1 to FS_ASYNC_MAX_WORKERS
+ * @param completion_eventfd eventfd incremented once per completed request, or -1
+ * @return 0 on success, -3 if already started, the arguments are invalid or a thread cannot be created
+ */
+int fs_async_start(int worker_count, int completion_eventfd);
+
+/**
+ * @brief Completes every queued request, then stops and joins the workers
+ */
+void fs_async_stop(void);
+
+/**
+ * @brief Queues a filled-in request
+ *
+ * @param request Request with opcode, filename and, for reads and writes, buffer or data and size
+ * @return 0 if queued, -3 if the pool is not running or the request is invalid
+ */
+int fs_async_submit(fs_async_request* request);
+
+/**
+ * @brief Fills in a request for fs_read and queues it
+ *
+ * @return 0 if queued, -3 if the pool is not running or the request is invalid
+ */
+int fs_async_read(fs_async_request* request, const char* filename, void* buffer, int size,
+                  fs_async_callback callback, void* user_data);
+
+/**
+ * @brief Fills in a request for fs_write and queues it
+ *
+ * @return 0 if queued, -3 if the pool is not running or the request is invalid
+ */
+int fs_async_write(fs_async_request* request, const char* filename, const void* data, int size,
+                   fs_async_callback callback, void* user_data);
+
+/**
+ * @brief Fills in a request for fs_create and queues it
+ *
+ * @return 0 if queued, -3 if the pool is not running or the request is invalid
+ */
+int fs_async_create(fs_async_request* request, const char* filename, fs_async_callback callback, void* user_data);
+
+/**
+ * @brief Fills in a request for fs_delete and queues it
+ *
+ * @return 0 if queued, -3 if the pool is not running or the request is invalid
+ */
+int fs_async_delete(fs_async_request* request, const char* filename, fs_async_callback callback, void* user_data);
+
+/**
+ * @brief Takes completed requests that have no callback off the completion queue
+ *
+ * Never blocks; pair it with the eventfd to wait for completions.
+ *
+ * @param completed Receives up to max_requests completed requests, oldest first
+ * @param max_requests Capacity of completed
+ * @return Number of requests returned, -3 if completed is NULL or max_requests is negative
+ */
+int fs_async_reap(fs_async_request** completed, int max_requests);
+
+/**
+ * @brief Blocks until every queued request has completed
+ */
+void fs_async_drain(void);
+
+/**
+ * @brief Takes the mutex the workers hold around each fs_* call
+ *
+ * Lets the caller make synchronous fs_* calls while requests are in flight.
+ */
+void fs_async_lock(void);
+
+/**
+ * @brief Releases the mutex taken by fs_async_lock
+ */
+void fs_async_unlock(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FS_ASYNC_H */
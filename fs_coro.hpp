@@ -0,0 +1,313 @@
+/**
+ * @file fs_coro.hpp
+ * @brief C++20 coroutine layer over the asynchronous OnlyFiles API
+ *
+ * onlyfiles::async_read/async_write/async_create/async_delete return awaitables
+ * that embed their fs_async_request, so awaiting one allocates nothing: the
+ * request lives in the awaiting coroutine's frame until the worker completes
+ * it. onlyfiles::task<T> composes such operations; its frames come from a
+ * recycling pool, so a steady stream of tasks stops touching the heap once
+ * the pool has warmed up.
+ *
+ * A completed operation resumes its coroutine on the worker thread that ran
+ * it. The fs_async worker pool must be running (fs_async_start) while any
+ * operation is awaited.
+ *
+ * Header-only; link with fs.c, fs_async.c and -pthread.
+ */
+
+#ifndef FS_CORO_HPP
+#define FS_CORO_HPP
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "fs_async.h"
+
+namespace onlyfiles {
+
+namespace detail {
+
+// Free lists of coroutine frames in 64-byte size classes up to 2 KB; larger
+// frames go straight to the global allocator.
+class frame_pool {
+public:
+    static void* allocate(std::size_t size) {
+        std::size_t size_class = class_of(size);
+        if (size_class >= class_count) {
+            return ::operator new(size);
+        }
+        frame_pool& pool = instance();
+        {
+            std::lock_guard<std::mutex> guard(pool.mutex_);
+            if (free_frame* frame = pool.free_lists_[size_class]) {
+                pool.free_lists_[size_class] = frame->next;
+                return frame;
+            }
+        }
+        return ::operator new((size_class + 1) * class_granularity);
+    }
+
+    static void deallocate(void* pointer, std::size_t size) noexcept {
+        std::size_t size_class = class_of(size);
+        if (size_class >= class_count) {
+            ::operator delete(pointer);
+            return;
+        }
+        frame_pool& pool = instance();
+        std::lock_guard<std::mutex> guard(pool.mutex_);
+        free_frame* frame = static_cast<free_frame*>(pointer);
+        frame->next = pool.free_lists_[size_class];
+        pool.free_lists_[size_class] = frame;
+    }
+
+private:
+    struct free_frame {
+        free_frame* next;
+    };
+
+    static constexpr std::size_t class_granularity = 64;
+    static constexpr std::size_t class_count = 32;
+
+    static std::size_t class_of(std::size_t size) noexcept { return (size - 1) / class_granularity; }
+
+    static frame_pool& instance() {
+        static frame_pool pool; // frames are recycled for the life of the process
+        return pool;
+    }
+
+    std::mutex mutex_;
+    free_frame* free_lists_[class_count] = {};
+};
+
+class promise_base {
+public:
+    static void* operator new(std::size_t size) { return frame_pool::allocate(size); }
+    static void operator delete(void* pointer, std::size_t size) noexcept { frame_pool::deallocate(pointer, size); }
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    // hands control to the awaiting coroutine, or marks a started task as done
+    struct final_awaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            promise_base& promise = handle.promise();
+            if (promise.continuation_) {
+                return promise.continuation_;
+            }
+            // notified under the lock, so the waiter cannot destroy the frame under our feet
+            std::lock_guard<std::mutex> guard(promise.done_mutex_);
+            promise.done_ = true;
+            promise.done_changed_.notify_all();
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    final_awaiter final_suspend() const noexcept { return {}; }
+
+    void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+    void set_continuation(std::coroutine_handle<> continuation) noexcept { continuation_ = continuation; }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(done_mutex_);
+        done_changed_.wait(lock, [this] { return done_; });
+    }
+
+protected:
+    void rethrow_if_failed() const {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+
+private:
+    std::coroutine_handle<> continuation_;
+    std::mutex done_mutex_;
+    std::condition_variable done_changed_;
+    bool done_ = false;
+    std::exception_ptr exception_;
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazily started coroutine producing a T
+ *
+ * Either co_await it from another coroutine, or start() it and later get()
+ * the result, which blocks until it finishes. A task is awaited or started
+ * once.
+ */
+template <typename T = void>
+class [[nodiscard]] task {
+public:
+    struct promise_type : detail::promise_base {
+        task get_return_object() noexcept { return task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+        template <typename Value>
+        void return_value(Value&& value) {
+            value_.emplace(std::forward<Value>(value));
+        }
+
+        T take_result() {
+            rethrow_if_failed();
+            return std::move(*value_);
+        }
+
+    private:
+        std::optional<T> value_;
+    };
+
+    task(task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+    ~task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().set_continuation(awaiting);
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().take_result(); }
+
+    /** @brief Runs the task on the calling thread until its first suspension */
+    void start() { handle_.resume(); }
+
+    /** @brief Blocks until a started task finishes and returns its result */
+    T get() {
+        handle_.promise().wait();
+        return handle_.promise().take_result();
+    }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <>
+class [[nodiscard]] task<void> {
+public:
+    struct promise_type : detail::promise_base {
+        task get_return_object() noexcept { return task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_void() const noexcept {}
+        void take_result() const { rethrow_if_failed(); }
+    };
+
+    task(task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+    ~task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().set_continuation(awaiting);
+        return handle_;
+    }
+    void await_resume() { handle_.promise().take_result(); }
+
+    /** @brief Runs the task on the calling thread until its first suspension */
+    void start() { handle_.resume(); }
+
+    /** @brief Blocks until a started task finishes */
+    void get() {
+        handle_.promise().wait();
+        handle_.promise().take_result();
+    }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * @brief Awaitable fs_async request; co_await yields the fs_* return value
+ *
+ * Submits on suspension and resumes the coroutine from the completion
+ * callback. If the request cannot be queued the coroutine continues at once
+ * with -3.
+ */
+class async_operation {
+public:
+    async_operation(const async_operation&) = delete;
+    async_operation& operator=(const async_operation&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        awaiting_ = awaiting;
+        request_.callback = &async_operation::resume_awaiting;
+        request_.user_data = this;
+        if (fs_async_submit(&request_) != 0) {
+            request_.result = -3;
+            return false; // not queued, so no callback will ever resume us
+        }
+        return true;
+    }
+
+    int await_resume() const noexcept { return request_.result; }
+
+private:
+    friend async_operation async_read(const char* filename, void* buffer, int size) noexcept;
+    friend async_operation async_write(const char* filename, const void* data, int size) noexcept;
+    friend async_operation async_create(const char* filename) noexcept;
+    friend async_operation async_delete(const char* filename) noexcept;
+
+    async_operation(int opcode, const char* filename, void* buffer, const void* data, int size) noexcept {
+        request_.opcode = opcode;
+        request_.filename = filename;
+        request_.buffer = buffer;
+        request_.data = data;
+        request_.size = size;
+    }
+
+    static void resume_awaiting(fs_async_request* request) {
+        static_cast<async_operation*>(request->user_data)->awaiting_.resume();
+    }
+
+    fs_async_request request_{};
+    std::coroutine_handle<> awaiting_;
+};
+
+/** @brief Awaitable fs_read; the buffer must stay valid until the await completes */
+inline async_operation async_read(const char* filename, void* buffer, int size) noexcept {
+    return async_operation(FS_ASYNC_READ, filename, buffer, nullptr, size);
+}
+
+/** @brief Awaitable fs_write; the data must stay valid until the await completes */
+inline async_operation async_write(const char* filename, const void* data, int size) noexcept {
+    return async_operation(FS_ASYNC_WRITE, filename, nullptr, data, size);
+}
+
+/** @brief Awaitable fs_create */
+inline async_operation async_create(const char* filename) noexcept {
+    return async_operation(FS_ASYNC_CREATE, filename, nullptr, nullptr, 0);
+}
+
+/** @brief Awaitable fs_delete */
+inline async_operation async_delete(const char* filename) noexcept {
+    return async_operation(FS_ASYNC_DELETE, filename, nullptr, nullptr, 0);
+}
+
+} // namespace onlyfiles
+
+#endif /* FS_CORO_HPP */
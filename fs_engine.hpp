@@ -0,0 +1,378 @@
+/**
+ * @file fs_engine.hpp
+ * @brief OnlyFiles engine specialized at compile time for one disk geometry
+ *
+ * onlyfiles::engine<Geometry> formats, mounts and serves images laid out by
+ * an onlyfiles::geometry. Every block, inode and bitmap offset it touches is a
+ * constant of that geometry, the bitmap and inode table are fixed-size members
+ * sized by it, and block arithmetic compiles down to shifts and masks. Unlike
+ * the C engine, which keeps one global mount per process, each engine object
+ * owns its own image, so tenants with different geometries can be served side
+ * by side.
+ *
+ * The on-disk format is the one fs.c writes: engine<default_geometry> mounts
+ * images made by fs_format, and fs_mount accepts what it writes. Inode
+ * records are written before the bitmap, the same order fs.c flushes in.
+ * Calls return the codes of the matching fs_* function.
+ *
+ * Header-only; the engine itself needs no fs.c.
+ */
+
+#ifndef FS_ENGINE_HPP
+#define FS_ENGINE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "fs_geometry.hpp"
+
+namespace onlyfiles {
+
+/**
+ * @brief Filesystem engine for images of one fixed geometry
+ *
+ * Not copyable; one object serves one image at a time and is not thread safe.
+ *
+ * @tparam Geometry An onlyfiles::geometry instantiation
+ */
+template <typename Geometry>
+class engine {
+public:
+    using layout = Geometry;
+
+    /** @brief On-disk inode record of this geometry, laid out like the inode struct of fs.h */
+    struct inode_record {
+        int used;
+        char name[MAX_FILENAME];
+        int size;
+        int blocks[Geometry::direct_blocks];
+    };
+    static_assert(sizeof(inode_record) == Geometry::inode_size, "inode record layout differs from the geometry");
+
+    /** @brief Writes an empty filesystem of this geometry to disk_path; 0 on success, -1 on error */
+    static int format(const std::string& disk_path) noexcept {
+        int fd = open(disk_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return -1;
+        }
+
+        // the image starts out sparse: zero blocks are a zero inode table and empty data
+        superblock initial{static_cast<int>(Geometry::block_count), static_cast<int>(Geometry::block_size),
+                           static_cast<int>(Geometry::data_blocks), static_cast<int>(Geometry::inode_count),
+                           static_cast<int>(Geometry::inode_count)};
+        std::array<unsigned char, bitmap_bytes> bitmap{};
+        for (std::uint32_t block = 0; block < Geometry::first_data_block; block++) {
+            bitmap[Geometry::bitmap_byte(block)] |= Geometry::bitmap_bit(block);
+        }
+        bool written = ftruncate(fd, static_cast<off_t>(Geometry::image_bytes)) == 0 &&
+                       pwrite(fd, &initial, sizeof(initial), 0) == static_cast<ssize_t>(sizeof(initial)) &&
+                       pwrite(fd, bitmap.data(), bitmap.size(), bitmap_offset) == static_cast<ssize_t>(bitmap.size());
+        close(fd);
+        return written ? 0 : -1;
+    }
+
+    engine() noexcept = default;
+    explicit engine(const std::string& disk_path) noexcept { mount(disk_path); }
+    engine(const engine&) = delete;
+    engine& operator=(const engine&) = delete;
+    ~engine() { unmount(); }
+
+    bool is_mounted() const noexcept { return fd_ >= 0; }
+
+    /** @brief Opens an image of this geometry; 0 on success, -1 if already mounted or the image does not match */
+    int mount(const std::string& disk_path) noexcept {
+        if (fd_ >= 0) {
+            return -1;
+        }
+        int fd = open(disk_path.c_str(), O_RDWR);
+        if (fd < 0) {
+            return -1;
+        }
+
+        superblock stored{};
+        bool loaded = pread(fd, &stored, sizeof(stored), 0) == static_cast<ssize_t>(sizeof(stored)) &&
+                      stored.total_blocks == static_cast<int>(Geometry::block_count) &&
+                      stored.block_size == static_cast<int>(Geometry::block_size) &&
+                      stored.total_inodes == static_cast<int>(Geometry::inode_count) &&
+                      pread(fd, bitmap_.data(), bitmap_.size(), bitmap_offset) == static_cast<ssize_t>(bitmap_.size()) &&
+                      pread(fd, inodes_.data(), sizeof(inodes_), inode_table_offset) == static_cast<ssize_t>(sizeof(inodes_));
+        if (!loaded) {
+            close(fd);
+            return -1;
+        }
+
+        // the bitmap and the inode table are the truth, the superblock counters may be stale
+        super_ = stored;
+        super_.free_blocks = 0;
+        for (std::uint32_t block = Geometry::first_data_block; block < Geometry::block_count; block++) {
+            super_.free_blocks += !block_used(block);
+        }
+        super_.free_inodes = 0;
+        for (const inode_record& record : inodes_) {
+            super_.free_inodes += !record.used;
+        }
+        fd_ = fd;
+        return 0;
+    }
+
+    /** @brief Writes the superblock and closes the image */
+    void unmount() noexcept {
+        if (fd_ < 0) {
+            return;
+        }
+        pwrite(fd_, &super_, sizeof(super_), 0);
+        close(fd_);
+        fd_ = -1;
+    }
+
+    /** @brief Like fs_create: 0, -1 if the file exists, -2 if no inode is free, -3 for other errors */
+    int create(std::string_view name) noexcept {
+        char stored[MAX_FILENAME];
+        if (fd_ < 0 || !stored_name(name, stored)) {
+            return -3;
+        }
+        if (find(stored) >= 0) {
+            return -1;
+        }
+        for (std::uint32_t index = 0; index < Geometry::inode_count; index++) {
+            if (!inodes_[index].used) {
+                inodes_[index] = inode_record{};
+                inodes_[index].used = 1;
+                std::memcpy(inodes_[index].name, stored, sizeof(stored));
+                super_.free_inodes--;
+                return store_inode(index) ? 0 : -3;
+            }
+        }
+        return -2;
+    }
+
+    /** @brief Like fs_delete: 0, -1 if the file does not exist, -2 for other errors */
+    int remove(std::string_view name) noexcept {
+        char stored[MAX_FILENAME];
+        if (fd_ < 0 || !stored_name(name, stored)) {
+            return -2;
+        }
+        int index = find(stored);
+        if (index < 0) {
+            return -1;
+        }
+        for (int& block : inodes_[index].blocks) {
+            release_block(block);
+        }
+        inodes_[index] = inode_record{};
+        super_.free_inodes++;
+        return (store_inode(index) && store_bitmap()) ? 0 : -2;
+    }
+
+    /** @brief Like fs_write: replaces the contents; 0, -1 if not found, -2 if out of space, -3 for other errors */
+    int write(std::string_view name, std::span<const std::byte> data) noexcept {
+        char stored[MAX_FILENAME];
+        if (fd_ < 0 || !stored_name(name, stored) || data.empty()) {
+            return -3;
+        }
+        if (data.size() > Geometry::max_file_size) {
+            return -2; // more than the direct blocks hold
+        }
+        int index = find(stored);
+        if (index < 0) {
+            return -1;
+        }
+
+        inode_record& record = inodes_[index];
+        std::uint32_t blocks_needed = Geometry::blocks_for(static_cast<std::uint32_t>(data.size()));
+        int kept = 0;
+        for (std::uint32_t i = 0; i < blocks_needed; i++) {
+            kept += record.blocks[i] != 0;
+        }
+        if (static_cast<int>(blocks_needed) - kept > super_.free_blocks) {
+            return -2;
+        }
+
+        // rewrite in place: keep the blocks inside the new size, free the rest, fill the holes first-fit
+        const inode_record previous = record;
+        for (std::uint32_t i = blocks_needed; i < Geometry::direct_blocks; i++) {
+            release_block(record.blocks[i]);
+        }
+        std::uint32_t search_from = Geometry::first_data_block;
+        for (std::uint32_t i = 0; i < blocks_needed; i++) {
+            if (record.blocks[i] == 0) {
+                while (block_used(search_from)) {
+                    search_from++;
+                }
+                claim_block(search_from);
+                record.blocks[i] = static_cast<int>(search_from);
+            }
+        }
+
+        // one pwritev per run of consecutive blocks; the last block is padded with zeros,
+        // fs.c relies on the bytes past the end of a file reading as zeros
+        std::array<std::byte, Geometry::block_size> tail_block{};
+        std::uint32_t written = 0;
+        for (std::uint32_t i = 0; i < blocks_needed;) {
+            std::uint32_t run = 1;
+            while (i + run < blocks_needed && record.blocks[i + run] == record.blocks[i] + static_cast<int>(run)) {
+                run++;
+            }
+            std::uint32_t run_bytes = std::min<std::uint32_t>(run << Geometry::block_shift,
+                                                              static_cast<std::uint32_t>(data.size()) - written);
+            std::uint32_t full_bytes = run_bytes & ~Geometry::block_mask;
+            std::uint32_t tail_bytes = run_bytes - full_bytes;
+            iovec vectors[2];
+            int vectors_count = 0;
+            if (full_bytes > 0) {
+                vectors[vectors_count++] = iovec{const_cast<std::byte*>(data.data() + written), full_bytes};
+            }
+            if (tail_bytes > 0) {
+                std::memcpy(tail_block.data(), data.data() + written + full_bytes, tail_bytes);
+                vectors[vectors_count++] = iovec{tail_block.data(), Geometry::block_size};
+            }
+            if (pwritev(fd_, vectors, vectors_count, block_position(record.blocks[i])) !=
+                static_cast<ssize_t>(run << Geometry::block_shift)) {
+                restore_block_map(record, previous);
+                return -3;
+            }
+            written += run_bytes;
+            i += run;
+        }
+
+        record.size = static_cast<int>(data.size());
+        return (store_inode(index) && store_bitmap()) ? 0 : -3;
+    }
+    int write(std::string_view name, std::string_view text) noexcept { return write(name, std::as_bytes(std::span(text))); }
+
+    /** @brief Like fs_read: bytes read, -1 if not found, -3 for other errors */
+    int read(std::string_view name, std::span<std::byte> buffer) const noexcept {
+        char stored[MAX_FILENAME];
+        if (fd_ < 0 || !stored_name(name, stored) || buffer.empty()) {
+            return -3;
+        }
+        int index = find(stored);
+        if (index < 0) {
+            return -1;
+        }
+
+        const inode_record& record = inodes_[index];
+        std::uint32_t to_read = std::min<std::uint32_t>(static_cast<std::uint32_t>(record.size),
+                                                        static_cast<std::uint32_t>(std::min<std::size_t>(buffer.size(), Geometry::max_file_size)));
+        for (std::uint32_t done = 0; done < to_read;) {
+            std::uint32_t i = Geometry::block_of(done);
+            std::uint32_t run = 1;
+            while (record.blocks[i] != 0 && i + run < Geometry::direct_blocks &&
+                   record.blocks[i + run] == record.blocks[i] + static_cast<int>(run)) {
+                run++;
+            }
+            std::uint32_t run_bytes = std::min<std::uint32_t>(run << Geometry::block_shift, to_read - done);
+            if (record.blocks[i] == 0) {
+                std::memset(buffer.data() + done, 0, run_bytes); // a hole
+            } else if (pread(fd_, buffer.data() + done, run_bytes, block_position(record.blocks[i])) !=
+                       static_cast<ssize_t>(run_bytes)) {
+                return -3;
+            }
+            done += run_bytes;
+        }
+        return static_cast<int>(to_read);
+    }
+    int read(std::string_view name, std::span<char> buffer) const noexcept { return read(name, std::as_writable_bytes(buffer)); }
+
+    /** @brief 1 if the file exists, 0 if not, -3 for an invalid name or when not mounted */
+    int exists(std::string_view name) const noexcept {
+        char stored[MAX_FILENAME];
+        if (fd_ < 0 || !stored_name(name, stored)) {
+            return -3;
+        }
+        return find(stored) >= 0;
+    }
+
+    /** @brief Data blocks not allocated to any file, -3 when not mounted */
+    int free_blocks() const noexcept { return (fd_ >= 0) ? super_.free_blocks : -3; }
+
+    /** @brief Inodes not in use, -3 when not mounted */
+    int free_inodes() const noexcept { return (fd_ >= 0) ? super_.free_inodes : -3; }
+
+private:
+    static constexpr std::size_t bitmap_bytes = static_cast<std::size_t>(Geometry::bitmap_blocks) << Geometry::block_shift;
+    static constexpr off_t bitmap_offset = static_cast<off_t>(Geometry::block_offset(Geometry::bitmap_block));
+    static constexpr off_t inode_table_offset = static_cast<off_t>(Geometry::block_offset(Geometry::inode_table_block));
+
+    static constexpr off_t block_position(int block) noexcept {
+        return static_cast<off_t>(Geometry::block_offset(static_cast<std::uint32_t>(block)));
+    }
+
+    // the inode keeps MAX_FILENAME - 1 characters, so names are compared in that form
+    static bool stored_name(std::string_view name, char (&stored)[MAX_FILENAME]) noexcept {
+        if (name.empty() || name.size() > MAX_FILENAME) {
+            return false;
+        }
+        std::size_t kept = std::min<std::size_t>(name.size(), MAX_FILENAME - 1);
+        std::memset(stored, 0, sizeof(stored));
+        std::memcpy(stored, name.data(), kept);
+        return true;
+    }
+
+    int find(const char (&stored)[MAX_FILENAME]) const noexcept {
+        for (std::uint32_t index = 0; index < Geometry::inode_count; index++) {
+            if (inodes_[index].used && std::strncmp(inodes_[index].name, stored, MAX_FILENAME) == 0) {
+                return static_cast<int>(index);
+            }
+        }
+        return -1;
+    }
+
+    bool block_used(std::uint32_t block) const noexcept {
+        return bitmap_[Geometry::bitmap_byte(block)] & Geometry::bitmap_bit(block);
+    }
+
+    void claim_block(std::uint32_t block) noexcept {
+        bitmap_[Geometry::bitmap_byte(block)] |= Geometry::bitmap_bit(block);
+        super_.free_blocks--;
+    }
+
+    void release_block(int& block) noexcept {
+        if (block != 0 && Geometry::is_data_block(static_cast<std::uint32_t>(block))) {
+            bitmap_[Geometry::bitmap_byte(block)] &= static_cast<unsigned char>(~Geometry::bitmap_bit(block));
+            super_.free_blocks++;
+        }
+        block = 0;
+    }
+
+    // undoes the block map changes of a failed write, the bitmap on disk was not written yet
+    void restore_block_map(inode_record& record, const inode_record& previous) noexcept {
+        for (std::uint32_t i = 0; i < Geometry::direct_blocks; i++) {
+            if (record.blocks[i] != previous.blocks[i]) {
+                release_block(record.blocks[i]);
+                if (previous.blocks[i] != 0) {
+                    claim_block(static_cast<std::uint32_t>(previous.blocks[i]));
+                }
+            }
+        }
+        record = previous;
+    }
+
+    bool store_inode(int index) noexcept {
+        return pwrite(fd_, &inodes_[index], sizeof(inode_record),
+                      static_cast<off_t>(Geometry::inode_offset(static_cast<std::uint32_t>(index)))) ==
+               static_cast<ssize_t>(sizeof(inode_record));
+    }
+
+    bool store_bitmap() noexcept {
+        return pwrite(fd_, bitmap_.data(), bitmap_.size(), bitmap_offset) == static_cast<ssize_t>(bitmap_.size());
+    }
+
+    int fd_ = -1;
+    superblock super_{};
+    std::array<unsigned char, bitmap_bytes> bitmap_{};
+    std::array<inode_record, Geometry::inode_count> inodes_{};
+};
+
+} // namespace onlyfiles
+
+#endif /* FS_ENGINE_HPP */
@@ -0,0 +1,652 @@
+/**
+ * @file fs_ext.h
+ * @brief Extension API for the OnlyFiles filesystem
+ *
+ * fs.h is the fixed interface of the assignment and must stay untouched, so
+ * every call beyond the original seven is declared here. The on-disk layout
+ * described in fs.h is unchanged: images produced through these extensions
+ * can still be mounted by a build that only knows fs.h.
+ *
+ * Unless documented otherwise, functions follow the fs.h conventions:
+ * 0 on success, -1 if the file was not found, -2 when out of space and
+ * -3 for other errors (not mounted, invalid parameters, I/O failure).
+ */
+
+#ifndef FS_EXT_H
+#define FS_EXT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fs.h"
+
+/**
+ * @brief Write policy: update files in place (default)
+ *
+ * Blocks are allocated first-fit from the start of the data region, so a
+ * rewritten file usually lands on the blocks it just released.
+ */
+#define FS_POLICY_IN_PLACE 0x0
+
+/**
+ * @brief Write policy: append all file data sequentially to a log
+ *
+ * Blocks are allocated next-fit from a log head that only moves forward and
+ * wraps to the start of the data region when it reaches the end of the image.
+ * Rewrites never overwrite the previous copy in place, so consecutive writes
+ * turn into one sequential stream on the device. Blocks released behind the
+ * head are reclaimed through the block bitmap when the head wraps around.
+ */
+#define FS_POLICY_LOG_STRUCTURED 0x1
+
+/**
+ * @brief Write policy: choose physical blocks when data is flushed, not on fs_write
+ *
+ * fs_write only copies the data into memory and reserves a block count against
+ * the free space, so running out of space is still reported by fs_write itself.
+ * The reservation covers only blocks the flush will newly allocate: blocks a
+ * file already owns inside its new size are reused in place, except under
+ * FS_POLICY_LOG_STRUCTURED, where every block of the new copy is new.
+ * Blocks are allocated as one contiguous run when the data is flushed: by
+ * fs_sync, fs_unmount, when this policy is switched off, or when the staging
+ * area is full. A file that is rewritten or deleted before that point never
+ * reaches the allocator or the disk. fs_read sees staged data immediately.
+ * A flush that fails keeps the staged data and its reservation, and the
+ * file keeps its old blocks, so a later flush can retry. Data that still
+ * cannot be flushed at fs_unmount is dropped.
+ */
+#define FS_POLICY_DELAYED_ALLOCATION 0x2
+
+/**
+ * @brief Selects how fs_write places data on the device
+ *
+ * The policy is process wide and may be changed at any time, mounted or not.
+ * It only affects where and when new blocks are allocated; the image stays
+ * compatible either way.
+ *
+ * @param policy_flags Combination of FS_POLICY_* flags
+ * @return 0 on success, -3 if unknown flags were given or staged data could not be flushed
+ */
+int fs_set_write_policy(int policy_flags);
+
+/**
+ * @brief Returns the currently active FS_POLICY_* flags
+ */
+int fs_get_write_policy(void);
+
+/**
+ * @brief Writes all pending state of the mounted filesystem to the disk image
+ *
+ * Flushes data held back by FS_POLICY_DELAYED_ALLOCATION, the inode table
+ * blocks changed since the last flush, the block bitmap and the superblock,
+ * then asks the host to make them durable. Every other operation already
+ * writes its inode table blocks and the bitmap to the image before it
+ * returns; fs_sync adds the superblock and the host-level flush.
+ *
+ * @return 0 on success, -3 if not mounted or on I/O error
+ */
+int fs_sync(void);
+
+/**
+ * @brief fs_fallocate mode: reserve blocks without changing the file size
+ *
+ * The reserved blocks stay attached to the file past its end and are not
+ * zeroed up front; they are overwritten by the first write that reaches them.
+ */
+#define FS_FALLOC_KEEP_SIZE 0x1
+
+/**
+ * @brief Preallocates the blocks covering the first 'length' bytes of a file
+ *
+ * Missing blocks are taken as one contiguous run when free space allows, so a
+ * file whose final size is known up front is not fragmented while it is
+ * written in pieces. Later writes up to 'length' bytes reuse these blocks and
+ * never call the allocator, also when a write is shorter than the one before
+ * it. Without FS_FALLOC_KEEP_SIZE the file grows to 'length' bytes and the new
+ * range reads as zeros.
+ *
+ * The blocks stay attached until the file is deleted or shrunk by
+ * fs_truncate. Which range a rewrite must keep is remembered in memory only:
+ * after a remount, blocks inside the file size count as ordinary data again.
+ * Under FS_POLICY_LOG_STRUCTURED a rewrite still moves the file to the log
+ * head, which releases the preallocated blocks.
+ *
+ * @param filename Name of the file to preallocate for
+ * @param length Number of bytes to cover, at most MAX_DIRECT_BLOCKS * BLOCK_SIZE
+ * @param mode 0 or FS_FALLOC_KEEP_SIZE
+ * @return 0 on success, -1 if file not found, -2 if out of space, -3 for other errors
+ */
+int fs_fallocate(const char* filename, int length, int mode);
+
+/**
+ * @brief Changes the size of a file without rewriting its data
+ *
+ * Shrinking releases every block past the new end, including a preallocated
+ * tail. Growing allocates nothing: the new range is a hole that reads as zeros
+ * until it is written. Only the inode and, when shrinking, the bitmap and the
+ * new last block are touched.
+ *
+ * @param filename Name of the file to resize
+ * @param new_size New size in bytes, at most MAX_DIRECT_BLOCKS * BLOCK_SIZE
+ * @return 0 on success, -1 if file not found, -2 if new_size is too large, -3 for other errors
+ */
+int fs_truncate(const char* filename, int new_size);
+
+/**
+ * @brief Renames a file, replacing the target if it already exists
+ *
+ * Only the name in the inode is rewritten; the data blocks are not touched.
+ * If a file named 'new_name' exists it is deleted after the rename, which
+ * makes "write a temporary file, then rename it over the original" a single
+ * inode update plus the release of the old copy.
+ *
+ * @param old_name Current name of the file
+ * @param new_name New name for the file (max 28 chars)
+ * @return 0 on success, -1 if old_name was not found, -3 for other errors
+ */
+int fs_rename(const char* old_name, const char* new_name);
+
+/** @brief fs_file_stat layout flag: all blocks form one physically contiguous run */
+#define FS_LAYOUT_CONTIGUOUS 0x1
+/** @brief fs_file_stat layout flag: part of the file is a hole that reads as zeros */
+#define FS_LAYOUT_HAS_HOLES 0x2
+/** @brief fs_file_stat layout flag: blocks are preallocated past the end of the file */
+#define FS_LAYOUT_PREALLOCATED 0x4
+/** @brief fs_file_stat layout flag: the contents are staged by delayed allocation */
+#define FS_LAYOUT_STAGED 0x8
+
+/**
+ * @brief Metadata of a single file, as returned by fs_stat
+ */
+typedef struct {
+    int size;                 /**< Size of the file in bytes */
+    int blocks;               /**< Data blocks owned by the file, preallocated ones included */
+    int extents;              /**< Number of physically contiguous block runs */
+    int layout_flags;         /**< Combination of FS_LAYOUT_* flags */
+    unsigned int generation;  /**< Changes on every modification; only comparable within one mount */
+} fs_file_stat;
+
+/**
+ * @brief Returns the metadata of a file without reading its data
+ *
+ * Resolved from the in-memory inode table, so it costs no disk I/O.
+ *
+ * @param filename Name of the file
+ * @param stat_buffer Receives the metadata
+ * @return 0 on success, -1 if file not found, -3 for other errors
+ */
+int fs_stat(const char* filename, fs_file_stat* stat_buffer);
+
+/**
+ * @brief Checks whether a file exists, without any disk I/O
+ *
+ * @param filename Name of the file
+ * @return 1 if the file exists, 0 if it does not, -3 if not mounted or the name is invalid
+ */
+int fs_exists(const char* filename);
+
+/**
+ * @brief Filesystem-wide space and inode counters, as returned by fs_statfs
+ *
+ * Block counts cover the data region only (blocks 10-2559).
+ */
+typedef struct {
+    int total_blocks;           /**< Data blocks in the filesystem */
+    int free_blocks;            /**< Data blocks not allocated to any file */
+    int reserved_blocks;        /**< Free blocks promised to staged delayed writes */
+    int available_blocks;       /**< free_blocks - reserved_blocks: what a new write may use */
+    int total_inodes;           /**< Inodes in the inode table */
+    int free_inodes;            /**< Inodes not used by any file */
+    int free_extents;           /**< Number of runs of consecutive free blocks */
+    int largest_free_extent;    /**< Length in blocks of the longest free run */
+    int fragmentation_percent;  /**< 0 when all free space is one run, towards 100 when scattered */
+} fs_statfs_info;
+
+/**
+ * @brief Returns space and inode counters of the mounted filesystem
+ *
+ * The counters are maintained by the block allocator on every change, so
+ * polling is O(1); only the largest free extent is recomputed, once, after the
+ * free space changed. At mount the counters are rebuilt from the bitmap and the
+ * inode table, so a stale superblock left by a crash does not leak into them.
+ *
+ * @param info Receives the counters
+ * @return 0 on success, -3 if not mounted or info is NULL
+ */
+int fs_statfs(fs_statfs_info* info);
+
+/**
+ * @brief Position of a paginated listing, see fs_list_next and fs_list_prefix
+ *
+ * Treat the contents as opaque. A zero-initialized cursor (FS_LIST_CURSOR_INIT)
+ * starts at the beginning of the listing. A cursor belongs to one listing and
+ * must not be shared between different listing calls.
+ */
+typedef struct {
+    int position;                          /**< Internal resume point of fs_list_next */
+    char resume_after[MAX_FILENAME + 1];   /**< Internal resume point of the ordered listings */
+} fs_list_cursor;
+
+/** @brief Initializer for a cursor that starts a new listing */
+#define FS_LIST_CURSOR_INIT {0, {0}}
+
+/**
+ * @brief One listed file, as returned by fs_list_next
+ */
+typedef struct {
+    const char* name;  /**< Points into the in-memory inode table, not copied */
+    int size;          /**< Size of the file in bytes */
+} fs_dirent;
+
+/**
+ * @brief Returns the next page of a listing
+ *
+ * Entries come straight from the in-memory inode table: no disk I/O and no
+ * rescan of the entries already returned, so listing everything in pages of
+ * any size is linear. A file that exists for the whole listing is returned
+ * exactly once; files created or deleted while paging may or may not appear.
+ *
+ * The name pointers stay valid until the file is renamed or deleted, or the
+ * filesystem is unmounted. Copy them if they must outlive that.
+ *
+ * @param cursor Resume point, advanced past the returned entries
+ * @param entries Array receiving up to max_entries entries
+ * @param max_entries Capacity of entries
+ * @return Number of entries returned (0 once the listing is complete), or -1 on error
+ */
+int fs_list_next(fs_list_cursor* cursor, fs_dirent* entries, int max_entries);
+
+/**
+ * @brief Returns the next page of files whose name starts with 'prefix', in name order
+ *
+ * Served from an ordered name index kept in memory and maintained by create,
+ * delete and rename: a page costs a binary search plus the entries returned.
+ * The cursor resumes after the last returned name, so files added or removed
+ * while paging never cause duplicates. An empty prefix lists every file in
+ * name order. Entry lifetime rules are the same as for fs_list_next.
+ *
+ * @param prefix Name prefix to match (may be empty)
+ * @param cursor Resume point, advanced past the returned entries
+ * @param entries Array receiving up to max_entries entries
+ * @param max_entries Capacity of entries
+ * @return Number of entries returned (0 once the listing is complete), or -1 on error
+ */
+int fs_list_prefix(const char* prefix, fs_list_cursor* cursor, fs_dirent* entries, int max_entries);
+
+/**
+ * @brief Returns the next page of files matching a shell glob, in name order
+ *
+ * Supports the fnmatch(3) syntax ('*', '?', '[...]'). The literal part of the
+ * pattern before the first wildcard narrows the scan to that prefix range of
+ * the ordered index, so "tenant42_*" only visits tenant42's files.
+ *
+ * @param pattern Glob pattern
+ * @param cursor Resume point, advanced past the returned entries
+ * @param entries Array receiving up to max_entries entries
+ * @param max_entries Capacity of entries
+ * @return Number of entries returned (0 once the listing is complete), or -1 on error
+ */
+int fs_list_glob(const char* pattern, fs_list_cursor* cursor, fs_dirent* entries, int max_entries);
+
+/**
+ * @brief Creates a directory
+ *
+ * The inode table is a single flat namespace, so a directory is a marker file
+ * whose name is the path followed by '/', and "a/b.txt" is a file inside it.
+ * Paths are resolved in one name index lookup whatever their depth. The parent
+ * directory of a nested path must exist. Files may still be created under a
+ * path prefix that has no marker; such implicit directories are not listed.
+ *
+ * @param path Directory path without leading or trailing '/', at most 26 chars
+ * @return 0 on success, -1 if it already exists, -2 if no free inodes, -3 for other errors (e.g. missing parent)
+ */
+int fs_mkdir(const char* path);
+
+/**
+ * @brief Removes an empty directory created by fs_mkdir
+ *
+ * @param path Directory path without leading or trailing '/'
+ * @return 0 on success, -1 if not found, -2 if the directory is not empty, -3 for other errors
+ */
+int fs_rmdir(const char* path);
+
+/**
+ * @brief Returns the next page of the direct children of a directory, in name order
+ *
+ * Only the part of the ordered name index under "path/" is visited, and whole
+ * subdirectory subtrees are skipped with one binary search each. Entries carry
+ * the full stored name ("dir/file"); subdirectories end with '/'. Entry lifetime
+ * rules are the same as for fs_list_next.
+ *
+ * @param path Directory path without trailing '/', or "" for the top level
+ * @param cursor Resume point, advanced past the returned entries
+ * @param entries Array receiving up to max_entries entries
+ * @param max_entries Capacity of entries
+ * @return Number of entries returned (0 once the listing is complete), or -1 on error
+ */
+int fs_list_dir(const char* path, fs_list_cursor* cursor, fs_dirent* entries, int max_entries);
+
+/**
+ * @brief Counters of the negative-lookup filter, as returned by fs_get_lookup_stats
+ *
+ * Every name lookup first consults an in-memory counting Bloom filter over the
+ * names of existing files. A name the filter has never seen is rejected
+ * without touching the name index. The false positive rate of the filter is
+ * false_positives / (false_positives + filtered_misses).
+ */
+typedef struct {
+    unsigned long lookups;          /**< Name lookups performed */
+    unsigned long filtered_misses;  /**< Lookups rejected by the filter alone */
+    unsigned long false_positives;  /**< Lookups the filter let through that found no file */
+    unsigned long hits;             /**< Lookups that found a file */
+} fs_lookup_stats;
+
+/**
+ * @brief Returns the name lookup counters collected since mount or the last reset
+ *
+ * @param stats Receives the counters
+ * @return 0 on success, -3 if stats is NULL
+ */
+int fs_get_lookup_stats(fs_lookup_stats* stats);
+
+/**
+ * @brief Resets the name lookup counters to zero
+ */
+void fs_reset_lookup_stats(void);
+
+/**
+ * @brief Creates several files with one write-back of the inode table
+ *
+ * Each name is handled like fs_create, in order, so a name repeated in the
+ * batch is created once and reported as existing afterwards. The inode table
+ * blocks touched by the batch are written once at the end.
+ *
+ * @param filenames Names of the files to create
+ * @param count Number of names
+ * @param results Optional, receives the fs_create result of each name
+ * @return Number of files created, or -3 if not mounted or the arguments are invalid
+ */
+int fs_create_many(const char* const* filenames, int count, int* results);
+
+/**
+ * @brief Deletes several files with one write-back of the bitmap and inode table
+ *
+ * @param filenames Names of the files to delete
+ * @param count Number of names
+ * @param results Optional, receives the fs_delete result of each name
+ * @return Number of files deleted, or -3 if not mounted or the arguments are invalid
+ */
+int fs_delete_many(const char* const* filenames, int count, int* results);
+
+/**
+ * @brief Returns the metadata of several files
+ *
+ * @param filenames Names of the files
+ * @param count Number of names
+ * @param stat_buffers Receives one fs_file_stat per name, untouched for failed names
+ * @param results Optional, receives the fs_stat result of each name
+ * @return Number of files found, or -3 if not mounted or the arguments are invalid
+ */
+int fs_stat_many(const char* const* filenames, int count, fs_file_stat* stat_buffers, int* results);
+
+/**
+ * @brief A group of writes and deletes applied together by fs_transaction_commit
+ *
+ * Operations are only recorded in memory until commit. Later operations on a
+ * name replace earlier ones, so each name is written or deleted at most once.
+ */
+typedef struct fs_transaction fs_transaction;
+
+/**
+ * @brief Starts an empty transaction
+ *
+ * @return The transaction, or NULL if it cannot be allocated
+ */
+fs_transaction* fs_transaction_begin(void);
+
+/**
+ * @brief Records a write of the whole contents of a file, creating it on commit if needed
+ *
+ * The data is copied, so the buffer can be reused right away.
+ *
+ * @param transaction Transaction from fs_transaction_begin
+ * @param filename Name of the file
+ * @param data Contents to write
+ * @param size Number of bytes to write
+ * @return 0 on success, -2 if size exceeds the maximum file size, -3 for invalid parameters
+ */
+int fs_transaction_write(fs_transaction* transaction, const char* filename, const void* data, int size);
+
+/**
+ * @brief Records the deletion of a file
+ *
+ * @param transaction Transaction from fs_transaction_begin
+ * @param filename Name of the file
+ * @return 0 on success, -3 for invalid parameters
+ */
+int fs_transaction_delete(fs_transaction* transaction, const char* filename);
+
+/**
+ * @brief Applies every recorded operation and makes the result durable with one fs_sync
+ *
+ * Writes staged by FS_POLICY_DELAYED_ALLOCATION are flushed first, and the
+ * group itself is applied without delayed allocation. All operations are then
+ * checked before the first one is applied: files to delete must exist, and
+ * the free blocks and inodes must cover every step of the group, counting
+ * only the blocks each rewrite really releases (a preallocated tail stays
+ * with its file). Deletes are applied first, then the writes that free
+ * blocks, then the writes that need more, so space released by the group is
+ * available to it. A failed check leaves the file contents untouched. The
+ * transaction is released whether the commit succeeds or not.
+ *
+ * There is no journal on disk, so the group is atomic against failed checks,
+ * not against a crash in the middle of the commit.
+ *
+ * @param transaction Transaction from fs_transaction_begin
+ * @return 0 on success, -1 if a file to delete does not exist, -2 if there is
+ *         not enough space or inodes, -3 if not mounted or on I/O error
+ */
+int fs_transaction_commit(fs_transaction* transaction);
+
+/**
+ * @brief Drops every recorded operation and releases the transaction
+ *
+ * @param transaction Transaction from fs_transaction_begin, may be NULL
+ */
+void fs_transaction_abort(fs_transaction* transaction);
+
+/**
+ * @brief Writes the new contents of a file chunk by chunk
+ *
+ * Holds one block of data in memory: every block that fills up is written to
+ * freshly allocated blocks right away. Readers keep seeing the previous
+ * contents until fs_write_stream_close publishes the new size and block list
+ * in one inode update, so the file never shows a partial stream. The old
+ * blocks are released at close, so a rewrite briefly needs room for both.
+ */
+typedef struct fs_write_stream fs_write_stream;
+
+/**
+ * @brief Starts replacing the contents of an existing file
+ *
+ * @param filename Name of the file
+ * @param stream Receives the stream
+ * @return 0 on success, -1 if file not found, -3 for other errors
+ */
+int fs_write_stream_open(const char* filename, fs_write_stream** stream);
+
+/**
+ * @brief Appends a chunk to the stream
+ *
+ * @param stream Stream from fs_write_stream_open
+ * @param data Chunk to append
+ * @param size Bytes in the chunk, 0 is allowed
+ * @return 0 on success, -2 if the file would exceed the maximum file size or
+ *         the disk is full, -3 for other errors
+ */
+int fs_write_stream_write(fs_write_stream* stream, const void* data, int size);
+
+/**
+ * @brief Writes the last partial block and publishes the new contents
+ *
+ * The stream is released whether or not the close succeeds.
+ *
+ * @param stream Stream from fs_write_stream_open
+ * @return 0 on success, -1 if the file was deleted meanwhile, -2 if the disk
+ *         is full, -3 for other errors (including a stream cut off by fs_unmount)
+ */
+int fs_write_stream_close(fs_write_stream* stream);
+
+/**
+ * @brief Drops the stream, keeping the previous contents of the file
+ *
+ * @param stream Stream from fs_write_stream_open, may be NULL
+ */
+void fs_write_stream_abort(fs_write_stream* stream);
+
+/**
+ * @brief Reads a file in chunks without a buffer the size of the file
+ *
+ * The stream reads runs of physically consecutive blocks with a single
+ * device read into an internal buffer of a few blocks and hands out pointers
+ * into it. Holes read as zeros. Data staged by FS_POLICY_DELAYED_ALLOCATION
+ * is flushed when the stream is opened.
+ *
+ * Each stream keeps an adaptive read-ahead window: every refill that
+ * continues where the previous one ended doubles it, every seek elsewhere
+ * halves it. The blocks in the window beyond the buffer are handed to the
+ * kernel with posix_fadvise(POSIX_FADV_WILLNEED), so they are read in the
+ * background while the caller works through the buffer.
+ */
+typedef struct fs_read_stream fs_read_stream;
+
+/**
+ * @brief Callback of fs_read_to_sink, called once per chunk in file order
+ *
+ * @param data Chunk contents, valid only during the call
+ * @param size Bytes in the chunk
+ * @param user_data Value passed to fs_read_to_sink
+ * @return 0 to continue, anything else to stop
+ */
+typedef int (*fs_read_sink)(const void* data, int size, void* user_data);
+
+/**
+ * @brief Opens a chunked read of a file from its start
+ *
+ * @param filename Name of the file
+ * @param stream Receives the stream
+ * @return 0 on success, -1 if file not found, -3 for other errors
+ */
+int fs_read_stream_open(const char* filename, fs_read_stream** stream);
+
+/**
+ * @brief Returns the next chunk of at most one block
+ *
+ * @param stream Stream from fs_read_stream_open
+ * @param chunk Receives a pointer to the chunk, valid until the next call on the stream
+ * @return Bytes in the chunk, 0 at the end of the file, -3 on error or if the
+ *         file was changed or deleted since the stream was opened
+ */
+int fs_read_stream_next(fs_read_stream* stream, const void** chunk);
+
+/**
+ * @brief Moves the read position of a stream
+ *
+ * The next chunk starts at offset. A seek away from the buffered run shrinks
+ * the read-ahead window when the next refill happens.
+ *
+ * @param stream Stream from fs_read_stream_open
+ * @param offset New position, 0 to the file size
+ * @return 0 on success, -3 if stream is NULL or offset is out of range
+ */
+int fs_read_stream_seek(fs_read_stream* stream, int offset);
+
+/**
+ * @brief Current read-ahead window of a stream
+ *
+ * @param stream Stream from fs_read_stream_open
+ * @return Window in blocks, -3 if stream is NULL
+ */
+int fs_read_stream_window(const fs_read_stream* stream);
+
+/**
+ * @brief Releases a read stream
+ *
+ * @param stream Stream from fs_read_stream_open, may be NULL
+ */
+void fs_read_stream_close(fs_read_stream* stream);
+
+/**
+ * @brief Passes a whole file to a callback, one buffered extent at a time
+ *
+ * Each call covers a run of consecutive blocks read with one device read (at
+ * most the stream buffer), or a stretch of zeros for a hole.
+ *
+ * @param filename Name of the file
+ * @param sink Callback receiving the chunks
+ * @param user_data Passed to the callback
+ * @return Bytes delivered (fewer if the sink stopped early), -1 if file not
+ *         found, -3 for other errors
+ */
+int fs_read_to_sink(const char* filename, fs_read_sink sink, void* user_data);
+
+/** @brief Access hint: no expectation, read streams adapt their read-ahead (default) */
+#define FS_ADVICE_NORMAL 0
+
+/** @brief Access hint: the file is read front to back, read streams start at the largest read-ahead window */
+#define FS_ADVICE_SEQUENTIAL 1
+
+/** @brief Access hint: reads jump around, read streams read only the block asked for and nothing ahead */
+#define FS_ADVICE_RANDOM 2
+
+/** @brief One-shot hint: the file will be read soon, its blocks are read into the host page cache in the background */
+#define FS_ADVICE_WILLNEED 3
+
+/**
+ * @brief Hint: the file will not be read again soon
+ *
+ * Evicts its blocks from the host page cache now, and from then on read
+ * streams evict each run of blocks as soon as they have handed it out, so a
+ * backup pass does not push hot files out of the cache.
+ */
+#define FS_ADVICE_DONTNEED 4
+
+/**
+ * @brief Tells the filesystem how a file is going to be read
+ *
+ * FS_ADVICE_NORMAL, _SEQUENTIAL and _RANDOM are kept per file and apply to
+ * read streams opened afterwards; FS_ADVICE_NORMAL also cancels a previous
+ * FS_ADVICE_DONTNEED. FS_ADVICE_WILLNEED acts once and leaves the stored hint
+ * alone. Hints live in memory only: they are dropped when the file is deleted
+ * and when the filesystem is mounted.
+ *
+ * @param filename Name of the file
+ * @param advice One of the FS_ADVICE_* values
+ * @return 0 on success, -1 if file not found, -3 if not mounted or the parameters are invalid
+ */
+int fs_advise(const char* filename, int advice);
+
+/**
+ * @brief Writes a whole file to a host file descriptor without copying it through user memory
+ *
+ * Each run of physically consecutive blocks is moved by the kernel straight
+ * from the image to out_fd: copy_file_range when out_fd is a regular file,
+ * sendfile for sockets, pipes and anything else copy_file_range refuses.
+ * Holes are written as zeros. Data staged by FS_POLICY_DELAYED_ALLOCATION
+ * is flushed first. Output starts at the current offset of out_fd and
+ * advances it.
+ *
+ * @param filename Name of the file
+ * @param out_fd Open, writable host file descriptor
+ * @return Bytes written (the file size), -1 if file not found, -3 if not
+ *         mounted, the parameters are invalid or out_fd failed; after a
+ *         failure part of the file may already have been written
+ */
+int fs_export_to_fd(const char* filename, int out_fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FS_EXT_H */
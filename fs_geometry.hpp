@@ -0,0 +1,137 @@
+/**
+ * @file fs_geometry.hpp
+ * @brief Compile-time disk geometry for OnlyFiles images
+ *
+ * onlyfiles::geometry computes the whole image layout from four parameters
+ * as constants: where the bitmap, the inode table and the data region start,
+ * how large an inode record is, and the largest file. Block arithmetic uses
+ * shifts and masks derived from the block size, and the invariants the
+ * format relies on are checked with static_assert, so an impossible geometry
+ * does not compile.
+ *
+ * onlyfiles::default_geometry is the geometry of fs.h and fs.c and is
+ * checked against their constants below. fs.c stays configured by those
+ * #defines; fs_engine.hpp builds an engine on top of any geometry here, so
+ * an image of another geometry can be mounted and served.
+ *
+ * Header-only.
+ */
+
+#ifndef FS_GEOMETRY_HPP
+#define FS_GEOMETRY_HPP
+
+#include <bit>
+#include <cstdint>
+
+#include "fs_ext.h" // fs.h itself has no extern "C" guards
+
+namespace onlyfiles {
+
+/** @brief Location of an inode record inside the inode table */
+struct inode_location {
+    std::uint32_t block;   /**< Absolute block number of the record's first byte */
+    std::uint32_t offset;  /**< Byte offset of the record inside that block */
+    bool straddles;        /**< The record continues into the next block */
+};
+
+/**
+ * @brief Image layout for a fixed geometry
+ *
+ * @tparam BlockSize Bytes per block, a power of two
+ * @tparam BlockCount Blocks in the image
+ * @tparam InodeCount Inodes in the inode table
+ * @tparam DirectBlocks Direct block pointers per inode
+ * @tparam InodeTableBlocks Blocks reserved for the inode table, at least the minimum that fits every record
+ */
+template <std::uint32_t BlockSize, std::uint32_t BlockCount, std::uint32_t InodeCount, std::uint32_t DirectBlocks,
+          std::uint32_t InodeTableBlocks = (InodeCount * (2 * sizeof(int) + MAX_FILENAME + DirectBlocks * sizeof(int)) +
+                                            BlockSize - 1) / BlockSize>
+struct geometry {
+    static constexpr std::uint32_t block_size = BlockSize;
+    static constexpr std::uint32_t block_count = BlockCount;
+    static constexpr std::uint32_t inode_count = InodeCount;
+    static constexpr std::uint32_t direct_blocks = DirectBlocks;
+
+    static constexpr std::uint32_t block_shift = std::countr_zero(BlockSize);
+    static constexpr std::uint32_t block_mask = BlockSize - 1;
+
+    // used flag, name, size and the direct pointers, as laid out by the inode struct of fs.h
+    static constexpr std::uint32_t inode_size = 2 * sizeof(int) + MAX_FILENAME + DirectBlocks * sizeof(int);
+
+    static constexpr std::uint32_t superblock_block = 0;
+    static constexpr std::uint32_t bitmap_block = 1;
+    static constexpr std::uint32_t bitmap_blocks = (BlockCount / 8 + BlockSize - 1) >> block_shift;
+    static constexpr std::uint32_t inode_table_block = bitmap_block + bitmap_blocks;
+    static constexpr std::uint32_t inode_table_blocks = InodeTableBlocks;
+    static constexpr std::uint32_t first_data_block = inode_table_block + inode_table_blocks;
+    static constexpr std::uint32_t data_blocks = BlockCount - first_data_block;
+
+    static constexpr std::uint64_t image_bytes = static_cast<std::uint64_t>(BlockCount) << block_shift;
+    static constexpr std::uint32_t max_file_size = DirectBlocks << block_shift;
+
+    static_assert(std::has_single_bit(BlockSize), "block size must be a power of two");
+    static_assert(BlockSize >= sizeof(superblock), "the superblock must fit in block 0");
+    static_assert(BlockCount % 8 == 0, "the bitmap covers whole bytes");
+    static_assert(inode_table_blocks * BlockSize >= InodeCount * inode_size, "inode table too small");
+    static_assert(first_data_block < BlockCount, "no room left for data");
+    static_assert(DirectBlocks > 0, "an inode needs at least one block pointer");
+    static_assert(BlockCount - 1 <= static_cast<std::uint32_t>(INT32_MAX), "block numbers are stored as int");
+
+    /** @brief Block holding byte offset within the image */
+    static constexpr std::uint32_t block_of(std::uint64_t byte_offset) noexcept {
+        return static_cast<std::uint32_t>(byte_offset >> block_shift);
+    }
+
+    /** @brief Byte offset within its block */
+    static constexpr std::uint32_t offset_in_block(std::uint64_t byte_offset) noexcept {
+        return static_cast<std::uint32_t>(byte_offset & block_mask);
+    }
+
+    /** @brief Byte offset of a block within the image */
+    static constexpr std::uint64_t block_offset(std::uint32_t block) noexcept {
+        return static_cast<std::uint64_t>(block) << block_shift;
+    }
+
+    /** @brief Blocks needed to hold size bytes */
+    static constexpr std::uint32_t blocks_for(std::uint32_t size) noexcept {
+        return (size + block_mask) >> block_shift;
+    }
+
+    /** @brief Byte offset of an inode record within the image */
+    static constexpr std::uint64_t inode_offset(std::uint32_t inode_index) noexcept {
+        return block_offset(inode_table_block) + static_cast<std::uint64_t>(inode_index) * inode_size;
+    }
+
+    /** @brief Block and in-block offset of an inode record */
+    static constexpr inode_location locate_inode(std::uint32_t inode_index) noexcept {
+        std::uint64_t first_byte = inode_offset(inode_index);
+        std::uint64_t last_byte = first_byte + inode_size - 1;
+        return inode_location{block_of(first_byte), offset_in_block(first_byte), block_of(last_byte) != block_of(first_byte)};
+    }
+
+    /** @brief Byte of the bitmap holding a block's bit, relative to the bitmap start */
+    static constexpr std::uint32_t bitmap_byte(std::uint32_t block) noexcept { return block >> 3; }
+
+    /** @brief Mask of a block's bit within its bitmap byte */
+    static constexpr std::uint8_t bitmap_bit(std::uint32_t block) noexcept {
+        return static_cast<std::uint8_t>(1u << (block & 7));
+    }
+
+    /** @brief Whether a block number belongs to the data region */
+    static constexpr bool is_data_block(std::uint32_t block) noexcept {
+        return block >= first_data_block && block < BlockCount;
+    }
+};
+
+/** @brief The geometry of fs.h; fs_format reserves 8 inode table blocks, more than the 6 the records need */
+using default_geometry = geometry<BLOCK_SIZE, MAX_BLOCKS, MAX_FILES, MAX_DIRECT_BLOCKS, 8>;
+
+static_assert(default_geometry::inode_size == sizeof(inode), "inode record size differs from fs.h");
+static_assert(default_geometry::inode_table_block == 2, "fs.c expects the inode table at block 2");
+static_assert(default_geometry::first_data_block == 10, "fs.c expects data to start at block 10");
+static_assert(default_geometry::image_bytes == 10u * 1024 * 1024, "fs_format creates a 10 MB image");
+static_assert(default_geometry::max_file_size == 48u * 1024, "fs_write allows 48 KB files");
+
+} // namespace onlyfiles
+
+#endif /* FS_GEOMETRY_HPP */
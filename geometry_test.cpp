@@ -0,0 +1,87 @@
+// compile with: gcc -c fs.c && g++ -std=c++20 -o geometry_test geometry_test.cpp fs.o
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "fs_geometry.hpp"
+
+#define TEST_DISK "test_geometry_disk.img"
+
+using onlyfiles::default_geometry;
+
+// a small-block tenant: 512-byte blocks, 2 MB image, 64 inodes, 8 pointers
+using small_geometry = onlyfiles::geometry<512, 4096, 64, 8>;
+static_assert(small_geometry::block_shift == 9 && small_geometry::block_mask == 511);
+static_assert(small_geometry::inode_size == 68);
+static_assert(small_geometry::inode_table_blocks == 9); // 64 * 68 bytes round up to 9 blocks
+static_assert(small_geometry::first_data_block == 11);
+static_assert(small_geometry::blocks_for(0) == 0 && small_geometry::blocks_for(513) == 2);
+static_assert(small_geometry::locate_inode(7).straddles && !small_geometry::locate_inode(0).straddles);
+
+// arithmetic on the default geometry, all evaluated at compile time
+static_assert(default_geometry::block_of(3 * BLOCK_SIZE + 5) == 3 && default_geometry::offset_in_block(3 * BLOCK_SIZE + 5) == 5);
+static_assert(default_geometry::locate_inode(48).block == 2 && default_geometry::locate_inode(48).straddles);
+static_assert(default_geometry::locate_inode(49).block == 3 && !default_geometry::locate_inode(49).straddles);
+static_assert(default_geometry::bitmap_byte(10) == 1 && default_geometry::bitmap_bit(10) == 0x4);
+static_assert(!default_geometry::is_data_block(9) && default_geometry::is_data_block(MAX_BLOCKS - 1));
+
+int main() {
+    std::printf("=== Testing compile-time geometry ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    char name[16];
+    for (int i = 0; i <= 48; i++) {
+        std::snprintf(name, sizeof(name), "g%d", i);
+        fs_create(name);
+    }
+    fs_write("g48", "geometry", 8);
+    fs_unmount();
+
+    int fd = open(TEST_DISK, O_RDONLY);
+
+    // Test 1: the image size matches the geometry
+    std::printf("Test 1 - Image size: ");
+    if (lseek(fd, 0, SEEK_END) == static_cast<off_t>(default_geometry::image_bytes)) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: a straddling inode record is where the geometry says
+    std::printf("Test 2 - Inode offset: ");
+    inode record;
+    pread(fd, &record, sizeof(record), default_geometry::inode_offset(48));
+    if (record.used == 1 && std::strcmp(record.name, "g48") == 0 && record.size == 8 &&
+        default_geometry::is_data_block(record.blocks[0])) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: the bitmap bit and the data block follow the same arithmetic
+    std::printf("Test 3 - Bitmap and data offsets: ");
+    unsigned char bitmap_byte = 0;
+    char data[8] = {};
+    pread(fd, &bitmap_byte, 1,
+          default_geometry::block_offset(default_geometry::bitmap_block) + default_geometry::bitmap_byte(record.blocks[0]));
+    pread(fd, data, sizeof(data), default_geometry::block_offset(record.blocks[0]));
+    if ((bitmap_byte & default_geometry::bitmap_bit(record.blocks[0])) && std::memcmp(data, "geometry", 8) == 0) {
+        std::printf("PASSED\n");
+    } else {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    close(fd);
+
+    std::printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
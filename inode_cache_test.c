@@ -0,0 +1,73 @@
+// compile with: gcc -o inode_cache_test inode_cache_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_inode_cache_disk.img"
+
+int main() {
+    char full_name[MAX_FILENAME + 1];
+    char long_name[MAX_FILENAME + 1];
+    char buffer[16];
+
+    printf("=== Testing inode cache name slots ===\n");
+
+    // the stored name keeps MAX_FILENAME - 1 characters and its terminator
+    memset(full_name, 'n', MAX_FILENAME - 1);
+    full_name[MAX_FILENAME - 1] = '\0';
+    memset(long_name, 'n', MAX_FILENAME);
+    long_name[MAX_FILENAME] = '\0';
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+
+    // Test 1: the longest storable name is found again
+    printf("Test 1 - Longest name: ");
+    if (fs_create(full_name) == 0 && fs_write(full_name, "data", 4) == 0 &&
+        fs_read(full_name, buffer, sizeof(buffer)) == 4 && fs_exists(full_name) == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: names differing only past the stored length or in the last byte do not match
+    printf("Test 2 - Near-miss names: ");
+    char last_differs[MAX_FILENAME + 1];
+    strcpy(last_differs, full_name);
+    last_differs[MAX_FILENAME - 2] = 'm';
+    if (fs_exists(long_name) == 0 && fs_exists(last_differs) == 0 && fs_exists("n") == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: sizes and block maps come back from the cache after remount
+    printf("Test 3 - Cache after remount: ");
+    fs_create("short");
+    fs_write("short", "0123456789", 10);
+    fs_unmount();
+    fs_mount(TEST_DISK);
+    fs_file_stat st;
+    memset(buffer, 0, sizeof(buffer));
+    if (fs_stat("short", &st) == 0 && st.size == 10 && st.blocks == 1 &&
+        fs_read("short", buffer, sizeof(buffer)) == 10 && memcmp(buffer, "0123456789", 10) == 0 &&
+        fs_exists(full_name) == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+// compile with: gcc -o inode_writeback_test inode_writeback_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/wait.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_inode_writeback_disk.img"
+
+// Helper to read one inode straight from the on-disk inode table
+int read_inode_on_disk(const char* path, int inode_index, inode* out) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    lseek(fd, 2 * BLOCK_SIZE + inode_index * sizeof(inode), SEEK_SET);
+    int result = (read(fd, out, sizeof(inode)) == sizeof(inode)) ? 0 : -1;
+    close(fd);
+    return result;
+}
+
+int main() {
+    inode on_disk;
+    char name[32];
+
+    printf("=== Testing inode table write-back ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+
+    // Test 1: every operation writes its inode table blocks before it returns
+    printf("Test 1 - Inode changes reach the image per operation: ");
+    fs_create("first.txt");
+    fs_write("first.txt", "hello", 5);
+    if (read_inode_on_disk(TEST_DISK, 0, &on_disk) == 0 && on_disk.used == 1 && on_disk.size == 5 &&
+        fs_exists("first.txt") == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: fs_sync writes the dirty blocks back
+    printf("Test 2 - fs_sync writes inodes: ");
+    fs_sync();
+    if (read_inode_on_disk(TEST_DISK, 0, &on_disk) == 0 && on_disk.used == 1 &&
+        strcmp(on_disk.name, "first.txt") == 0 && on_disk.size == 5) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: an inode that straddles two table blocks is written whole
+    printf("Test 3 - Inode across a block boundary: ");
+    int straddling = BLOCK_SIZE / sizeof(inode); // starts in the first block, ends in the second
+    for (int i = 1; i <= straddling; i++) {
+        snprintf(name, sizeof(name), "file%d", i);
+        fs_create(name);
+    }
+    snprintf(name, sizeof(name), "file%d", straddling);
+    fs_write(name, "0123456789", 10);
+    fs_unmount();
+    if (read_inode_on_disk(TEST_DISK, straddling, &on_disk) == 0 && on_disk.used == 1 &&
+        strcmp(on_disk.name, name) == 0 && on_disk.size == 10) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: the flushed table mounts back intact
+    printf("Test 4 - Table after remount: ");
+    char buffer[16] = {0};
+    fs_mount(TEST_DISK);
+    if (fs_read(name, buffer, sizeof(buffer)) == 10 && memcmp(buffer, "0123456789", 10) == 0 &&
+        fs_read("first.txt", buffer, sizeof(buffer)) == 5) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 5: a process that dies without unmounting leaves inodes and bitmap in step
+    printf("Test 5 - Crash after delete and write: ");
+    fs_create("keep");
+    fs_write("keep", "keep-data", 9);
+    fs_unmount();
+    pid_t child = fork();
+    if (child == 0) {
+        fs_mount(TEST_DISK);
+        fs_delete("keep");
+        fs_create("late");
+        fs_write("late", "late-data", 9);
+        _exit(0); // no fs_unmount, no fs_sync
+    }
+    waitpid(child, NULL, 0);
+    fs_mount(TEST_DISK);
+    fs_create("reuse");
+    fs_write("reuse", "new-bytes", 9);
+    memset(buffer, 0, sizeof(buffer));
+    int late_read = fs_read("late", buffer, sizeof(buffer));
+    if (fs_exists("keep") == 0 && late_read == 9 && memcmp(buffer, "late-data", 9) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - keep exists %d, late read %d\n", fs_exists("keep"), late_read);
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
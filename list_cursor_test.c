@@ -0,0 +1,88 @@
+// compile with: gcc -o list_cursor_test list_cursor_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_list_cursor_disk.img"
+#define NUM_FILES 100
+
+int main() {
+    char name[MAX_FILENAME];
+    char contents[NUM_FILES] = {0}; // file i holds its first i + 1 bytes
+    int seen[NUM_FILES] = {0};
+    fs_dirent page[7];
+
+    printf("=== Testing fs_list_next ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    for (int i = 0; i < NUM_FILES; i++) {
+        snprintf(name, sizeof(name), "page_%d", i);
+        fs_create(name);
+        fs_write(name, contents, i + 1);
+    }
+
+    // Test 1: invalid parameters
+    printf("Test 1 - Error codes: ");
+    fs_list_cursor cursor = FS_LIST_CURSOR_INIT;
+    if (fs_list_next(NULL, page, 7) == -1 && fs_list_next(&cursor, NULL, 7) == -1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: paging returns every file exactly once with its size
+    printf("Test 2 - Pages cover every file once: ");
+    int total = 0;
+    int sizes_match = 1;
+    int count;
+    while ((count = fs_list_next(&cursor, page, 7)) > 0) {
+        for (int i = 0; i < count; i++) {
+            int file_number = -1;
+            sscanf(page[i].name, "page_%d", &file_number);
+            if (file_number < 0 || file_number >= NUM_FILES) return 1;
+            seen[file_number]++;
+            if (page[i].size != file_number + 1) sizes_match = 0;
+            total++;
+        }
+    }
+    int each_once = 1;
+    for (int i = 0; i < NUM_FILES; i++) {
+        if (seen[i] != 1) each_once = 0;
+    }
+    if (count == 0 && total == NUM_FILES && each_once && sizes_match &&
+        fs_list_next(&cursor, page, 7) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - %d entries\n", total);
+        return 1;
+    }
+
+    // Test 3: deleting behind the cursor does not disturb the rest of the listing
+    printf("Test 3 - Delete while paging: ");
+    fs_list_cursor second_cursor = FS_LIST_CURSOR_INIT;
+    count = fs_list_next(&second_cursor, page, 7);
+    fs_delete(page[0].name);
+    total = count;
+    while ((count = fs_list_next(&second_cursor, page, 7)) > 0) {
+        total += count;
+    }
+    if (total == NUM_FILES) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - %d entries\n", total);
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+// compile with: gcc -o log_policy_test log_policy_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_log_disk.img"
+
+// Helper to check whether a block is marked as used in the on-disk bitmap
+int block_is_used_on_disk(const char* path, int block_index) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    unsigned char bitmap[BLOCK_SIZE];
+    lseek(fd, BLOCK_SIZE, SEEK_SET);
+    if (read(fd, bitmap, BLOCK_SIZE) != BLOCK_SIZE) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    return (bitmap[block_index / 8] & (1 << (block_index % 8))) ? 1 : 0;
+}
+
+int main() {
+    char data[2 * BLOCK_SIZE];
+    char buffer[2 * BLOCK_SIZE];
+
+    printf("=== Testing FS_POLICY_LOG_STRUCTURED ===\n");
+
+    // Test 1: policy flags validation
+    printf("Test 1 - Policy validation: ");
+    if (fs_set_write_policy(0x80) == -3 && fs_get_write_policy() == FS_POLICY_IN_PLACE &&
+        fs_set_write_policy(FS_POLICY_LOG_STRUCTURED) == 0 &&
+        fs_get_write_policy() == FS_POLICY_LOG_STRUCTURED) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("log.txt");
+
+    // Test 2: a rewrite is appended after the previous copy instead of overwriting it
+    printf("Test 2 - Rewrite appends to the log: ");
+    memset(data, 'A', sizeof(data));
+    fs_write("log.txt", data, sizeof(data)); // blocks 10-11
+    memset(data, 'B', sizeof(data));
+    fs_write("log.txt", data, sizeof(data)); // blocks 12-13
+    if (block_is_used_on_disk(TEST_DISK, 10) == 0 && block_is_used_on_disk(TEST_DISK, 12) == 1 &&
+        block_is_used_on_disk(TEST_DISK, 13) == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - data was not appended at the log head\n");
+        return 1;
+    }
+
+    // Test 3: data survives remount and the log keeps growing from its head
+    printf("Test 3 - Log head after remount: ");
+    fs_unmount();
+    fs_mount(TEST_DISK);
+    fs_create("second.txt");
+    fs_write("second.txt", "x", 1); // block 14, not the released block 10
+    if (fs_read("log.txt", buffer, sizeof(buffer)) == (int)sizeof(buffer) &&
+        memcmp(buffer, data, sizeof(data)) == 0 && block_is_used_on_disk(TEST_DISK, 14) == 1 &&
+        block_is_used_on_disk(TEST_DISK, 10) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+    fs_set_write_policy(FS_POLICY_IN_PLACE);
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
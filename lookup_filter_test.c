@@ -0,0 +1,97 @@
+// compile with: gcc -o lookup_filter_test lookup_filter_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_lookup_filter_disk.img"
+
+int main() {
+    fs_lookup_stats stats;
+    char name[32];
+
+    printf("=== Testing name lookup filter ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    for (int i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "file%d.txt", i);
+        fs_create(name);
+    }
+
+    // Test 1: argument validation
+    printf("Test 1 - NULL stats rejected: ");
+    if (fs_get_lookup_stats(NULL) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: existing names are always found
+    printf("Test 2 - No false negatives: ");
+    fs_reset_lookup_stats();
+    int found = 0;
+    for (int i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "file%d.txt", i);
+        found += fs_exists(name) == 1;
+    }
+    fs_get_lookup_stats(&stats);
+    if (found == 100 && stats.lookups == 100 && stats.hits == 100 && stats.filtered_misses == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - found %d, hits %lu\n", found, stats.hits);
+        return 1;
+    }
+
+    // Test 3: most missing names are rejected by the filter alone
+    printf("Test 3 - Missing names filtered: ");
+    fs_reset_lookup_stats();
+    int missing = 0;
+    for (int i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "absent%d.dat", i);
+        missing += fs_exists(name) == 0;
+    }
+    fs_get_lookup_stats(&stats);
+    if (missing == 1000 && stats.filtered_misses + stats.false_positives == 1000 &&
+        stats.false_positives < 50) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - %lu false positives\n", stats.false_positives);
+        return 1;
+    }
+
+    // Test 4: deleted and renamed names leave the filter
+    printf("Test 4 - Filter follows delete and rename: ");
+    fs_delete("file0.txt");
+    fs_rename("file1.txt", "moved.txt");
+    if (fs_exists("file0.txt") == 0 && fs_exists("file1.txt") == 0 && fs_exists("moved.txt") == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 5: the filter is rebuilt from the inode table on mount
+    printf("Test 5 - Filter after remount: ");
+    fs_unmount();
+    fs_mount(TEST_DISK);
+    fs_get_lookup_stats(&stats);
+    if (stats.lookups == 0 && fs_exists("moved.txt") == 1 && fs_exists("file99.txt") == 1 &&
+        fs_exists("file0.txt") == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+// compile with: gcc -o prefix_list_test prefix_list_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_prefix_disk.img"
+
+// Helper to drain a listing in small pages and check that names come back sorted
+int drain_listing(const char* prefix, const char* pattern) {
+    fs_list_cursor cursor = FS_LIST_CURSOR_INIT;
+    fs_dirent page[3];
+    char previous[MAX_FILENAME + 1] = "";
+    int total = 0;
+    int count;
+    do {
+        count = pattern ? fs_list_glob(pattern, &cursor, page, 3) : fs_list_prefix(prefix, &cursor, page, 3);
+        for (int i = 0; i < count; i++) {
+            if (strcmp(previous, page[i].name) >= 0) return -1; // out of order or duplicate
+            strncpy(previous, page[i].name, MAX_FILENAME);
+            total++;
+        }
+    } while (count > 0);
+    return (count < 0) ? -1 : total;
+}
+
+int main() {
+    char name[MAX_FILENAME];
+
+    printf("=== Testing fs_list_prefix and fs_list_glob ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+
+    // created in reverse order so the inode order differs from the name order
+    for (int tenant = 9; tenant >= 0; tenant--) {
+        for (int i = 9; i >= 0; i--) {
+            snprintf(name, sizeof(name), "tenant%d_obj%d.%s", tenant, i, (i % 2) ? "log" : "dat");
+            fs_create(name);
+        }
+    }
+
+    // Test 1: invalid parameters
+    printf("Test 1 - Error codes: ");
+    fs_list_cursor cursor = FS_LIST_CURSOR_INIT;
+    fs_dirent page[3];
+    if (fs_list_prefix(NULL, &cursor, page, 3) == -1 && fs_list_glob("*", NULL, page, 3) == -1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: prefix ranges in name order
+    printf("Test 2 - Prefix listing: ");
+    if (drain_listing("tenant3_", NULL) == 10 && drain_listing("", NULL) == 100 &&
+        drain_listing("tenant3_obj7", NULL) == 1 && drain_listing("nobody", NULL) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: glob patterns
+    printf("Test 3 - Glob listing: ");
+    if (drain_listing(NULL, "tenant5_*.log") == 5 && drain_listing(NULL, "*obj[12].*") == 20 &&
+        drain_listing(NULL, "tenant?_obj0.dat") == 10 && drain_listing(NULL, "*.txt") == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: the ordered index follows create, delete and rename
+    printf("Test 4 - Index maintenance: ");
+    fs_delete("tenant3_obj0.dat");
+    fs_rename("tenant3_obj1.log", "tenant4_moved.log");
+    fs_create("tenant3_new");
+    if (drain_listing("tenant3_", NULL) == 9 && drain_listing("tenant4_", NULL) == 11) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 5: files added behind the cursor while paging are not returned twice
+    printf("Test 5 - Stable cursor: ");
+    fs_list_cursor paging_cursor = FS_LIST_CURSOR_INIT;
+    int total = fs_list_prefix("tenant7_", &paging_cursor, page, 3);
+    fs_create("tenant7_aaa"); // sorts before everything already returned
+    int count;
+    while ((count = fs_list_prefix("tenant7_", &paging_cursor, page, 3)) > 0) {
+        total += count;
+    }
+    if (total == 10) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - %d entries\n", total);
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
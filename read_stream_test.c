@@ -0,0 +1,117 @@
+// compile with: gcc -o read_stream_test read_stream_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_read_stream_disk.img"
+
+static char collected[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+
+typedef struct {
+    int bytes;
+    int calls;
+    int stop_after;
+} sink_state;
+
+int collect_sink(const void* data, int size, void* user_data) {
+    sink_state* state = (sink_state*)user_data;
+    memcpy(collected + state->bytes, data, size);
+    state->bytes += size;
+    state->calls++;
+    return state->stop_after > 0 && state->calls >= state->stop_after;
+}
+
+int main() {
+    static char expected[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+    fs_read_stream* stream = NULL;
+    const void* chunk;
+
+    printf("=== Testing chunked reads ===\n");
+
+    for (int i = 0; i < (int)sizeof(expected); i++) {
+        expected[i] = (char)(i % 251);
+    }
+    int size = 6 * BLOCK_SIZE + 100;
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("data.bin");
+    fs_write("data.bin", expected, size);
+
+    // Test 1: open validation
+    printf("Test 1 - Open validation: ");
+    if (fs_read_stream_open("missing", &stream) == -1 && fs_read_stream_open("data.bin", NULL) == -3 &&
+        fs_read_to_sink("data.bin", NULL, NULL) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: block-sized chunks reproduce the file
+    printf("Test 2 - Chunks cover the file: ");
+    fs_read_stream_open("data.bin", &stream);
+    int total = 0, chunks = 0, largest = 0, got;
+    while ((got = fs_read_stream_next(stream, &chunk)) > 0) {
+        memcpy(collected + total, chunk, got);
+        total += got;
+        chunks++;
+        largest = (got > largest) ? got : largest;
+    }
+    fs_read_stream_close(stream);
+    if (got == 0 && total == size && chunks == 7 && largest == BLOCK_SIZE && memcmp(collected, expected, size) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - %d bytes in %d chunks\n", total, chunks);
+        return 1;
+    }
+
+    // Test 3: the sink gets whole extents, holes as zeros, and can stop early
+    printf("Test 3 - Sink extents, holes and early stop: ");
+    fs_truncate("data.bin", BLOCK_SIZE);
+    fs_truncate("data.bin", 3 * BLOCK_SIZE); // blocks 1-2 are now a hole
+    memset(collected, 0x7F, sizeof(collected));
+    sink_state state = {0, 0, 0};
+    int delivered = fs_read_to_sink("data.bin", collect_sink, &state);
+    char zeros[2 * BLOCK_SIZE] = {0};
+    int content_ok = memcmp(collected, expected, BLOCK_SIZE) == 0 && memcmp(collected + BLOCK_SIZE, zeros, sizeof(zeros)) == 0;
+    fs_write("data.bin", expected, size);
+    sink_state stopping = {0, 0, 1};
+    int partial = fs_read_to_sink("data.bin", collect_sink, &stopping);
+    if (delivered == 3 * BLOCK_SIZE && content_ok && partial > 0 && partial < size && stopping.calls == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - delivered %d, partial %d\n", delivered, partial);
+        return 1;
+    }
+
+    // Test 4: staged data is flushed at open, a rewrite ends the stream
+    printf("Test 4 - Staged data and concurrent rewrite: ");
+    fs_set_write_policy(FS_POLICY_DELAYED_ALLOCATION);
+    fs_write("data.bin", "staged", 6);
+    fs_read_stream_open("data.bin", &stream);
+    int first = fs_read_stream_next(stream, &chunk);
+    int staged_ok = first == 6 && memcmp(chunk, "staged", 6) == 0;
+    fs_read_stream_close(stream);
+    fs_set_write_policy(FS_POLICY_IN_PLACE);
+    fs_read_stream_open("data.bin", &stream);
+    fs_write("data.bin", expected, size);
+    if (staged_ok && fs_read_stream_next(stream, &chunk) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+    fs_read_stream_close(stream);
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+// compile with: gcc -o readahead_test readahead_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_readahead_disk.img"
+
+int main() {
+    static char expected[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+    static char collected[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+    fs_read_stream* stream = NULL;
+    const void* chunk;
+
+    printf("=== Testing read-ahead ===\n");
+
+    for (int i = 0; i < (int)sizeof(expected); i++) {
+        expected[i] = (char)(i % 239);
+    }
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("big.bin");
+    fs_write("big.bin", expected, sizeof(expected));
+
+    // Test 1: seek validation
+    printf("Test 1 - Seek validation: ");
+    fs_read_stream_open("big.bin", &stream);
+    if (fs_read_stream_seek(NULL, 0) == -3 && fs_read_stream_seek(stream, -1) == -3 &&
+        fs_read_stream_seek(stream, sizeof(expected) + 1) == -3 && fs_read_stream_seek(stream, sizeof(expected)) == 0 &&
+        fs_read_stream_next(stream, &chunk) == 0 && fs_read_stream_window(NULL) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+    fs_read_stream_close(stream);
+
+    // Test 2: a sequential read grows the window up to its limit
+    printf("Test 2 - Sequential reads grow the window: ");
+    fs_read_stream_open("big.bin", &stream);
+    int initial_window = fs_read_stream_window(stream);
+    int total = 0, got;
+    while ((got = fs_read_stream_next(stream, &chunk)) > 0) {
+        memcpy(collected + total, chunk, got);
+        total += got;
+    }
+    int final_window = fs_read_stream_window(stream);
+    fs_read_stream_close(stream);
+    if (got == 0 && total == (int)sizeof(expected) && memcmp(collected, expected, total) == 0 &&
+        final_window > initial_window && final_window == MAX_DIRECT_BLOCKS) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - window %d -> %d, %d bytes\n", initial_window, final_window, total);
+        return 1;
+    }
+
+    // Test 3: seeks shrink the window, resuming sequential reads grows it again
+    printf("Test 3 - Random reads shrink the window: ");
+    fs_read_stream_open("big.bin", &stream);
+    int positions[] = {10, 2, 7, 0};
+    int random_ok = 1;
+    for (int i = 0; i < 4; i++) {
+        fs_read_stream_seek(stream, positions[i] * BLOCK_SIZE + 5);
+        got = fs_read_stream_next(stream, &chunk);
+        random_ok = random_ok && got == BLOCK_SIZE - 5 &&
+                    memcmp(chunk, expected + positions[i] * BLOCK_SIZE + 5, got) == 0;
+    }
+    int random_window = fs_read_stream_window(stream);
+    for (int i = 0; i < 4; i++) {
+        got = fs_read_stream_next(stream, &chunk);
+        random_ok = random_ok && got == BLOCK_SIZE && memcmp(chunk, expected + (i + 1) * BLOCK_SIZE, got) == 0;
+    }
+    int recovered_window = fs_read_stream_window(stream);
+    fs_read_stream_close(stream);
+    if (random_ok && random_window == 1 && recovered_window > random_window) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - window %d then %d\n", random_window, recovered_window);
+        return 1;
+    }
+
+    // Test 4: read-ahead skips holes and still reads zeros there
+    printf("Test 4 - Holes inside the window: ");
+    fs_truncate("big.bin", BLOCK_SIZE);
+    fs_truncate("big.bin", 8 * BLOCK_SIZE);
+    char zeros[BLOCK_SIZE] = {0};
+    fs_read_stream_open("big.bin", &stream);
+    int blocks = 0, hole_ok = 1;
+    while ((got = fs_read_stream_next(stream, &chunk)) > 0) {
+        hole_ok = hole_ok && memcmp(chunk, (blocks == 0) ? expected : zeros, got) == 0;
+        blocks++;
+    }
+    fs_read_stream_close(stream);
+    if (got == 0 && blocks == 8 && hole_ok) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+// compile with: gcc -o rename_test rename_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_rename_disk.img"
+
+// Helper to count used data blocks in the on-disk bitmap
+int count_used_data_blocks_on_disk(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    unsigned char bitmap[BLOCK_SIZE];
+    lseek(fd, BLOCK_SIZE, SEEK_SET);
+    if (read(fd, bitmap, BLOCK_SIZE) != BLOCK_SIZE) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    int used = 0;
+    for (int block_index = 10; block_index < MAX_BLOCKS; block_index++) {
+        if (bitmap[block_index / 8] & (1 << (block_index % 8))) used++;
+    }
+    return used;
+}
+
+int main() {
+    char buffer[2 * BLOCK_SIZE];
+    char name[MAX_FILENAME];
+
+    printf("=== Testing fs_rename ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+
+    // Test 1: invalid parameters
+    printf("Test 1 - Error codes: ");
+    fs_create("a.txt");
+    if (fs_rename("missing.txt", "b.txt") == -1 && fs_rename(NULL, "b.txt") == -3 &&
+        fs_rename("a.txt", "") == -3 && fs_rename("a.txt", "a.txt") == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: plain rename keeps the data
+    printf("Test 2 - Rename keeps data: ");
+    fs_write("a.txt", "payload", 8);
+    if (fs_rename("a.txt", "b.txt") == 0 && fs_read("a.txt", buffer, sizeof(buffer)) == -1 &&
+        fs_read("b.txt", buffer, sizeof(buffer)) == 8 && strcmp(buffer, "payload") == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: write-temp-then-rename replaces the target and frees its blocks
+    printf("Test 3 - Rename replaces existing target: ");
+    char data[2 * BLOCK_SIZE];
+    memset(data, 'N', sizeof(data));
+    fs_create("b.txt.tmp");
+    fs_write("b.txt.tmp", data, sizeof(data));
+    char names[4][MAX_FILENAME];
+    if (fs_rename("b.txt.tmp", "b.txt") == 0 && count_used_data_blocks_on_disk(TEST_DISK) == 2 &&
+        fs_list(names, 4) == 1 && strcmp(names[0], "b.txt") == 0 &&
+        fs_read("b.txt", buffer, sizeof(buffer)) == (int)sizeof(data) &&
+        memcmp(buffer, data, sizeof(data)) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: the name index stays consistent under churn and across remount
+    printf("Test 4 - Name index under churn: ");
+    for (int i = 0; i < 200; i++) {
+        snprintf(name, sizeof(name), "churn_%d", i);
+        fs_create(name);
+    }
+    for (int i = 0; i < 200; i += 2) {
+        snprintf(name, sizeof(name), "churn_%d", i);
+        fs_delete(name);
+    }
+    for (int i = 1; i < 200; i += 2) {
+        char new_name[MAX_FILENAME];
+        snprintf(name, sizeof(name), "churn_%d", i);
+        snprintf(new_name, sizeof(new_name), "renamed_%d", i);
+        fs_rename(name, new_name);
+    }
+    int consistent = 1;
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            fs_unmount();
+            fs_mount(TEST_DISK);
+        }
+        for (int i = 0; i < 200; i++) {
+            snprintf(name, sizeof(name), "churn_%d", i);
+            if (fs_read(name, buffer, 1) != -1) consistent = 0;
+            snprintf(name, sizeof(name), "renamed_%d", i);
+            if ((fs_read(name, buffer, 1) == 0) != (i % 2 == 1)) consistent = 0;
+        }
+    }
+    if (consistent && fs_read("b.txt", buffer, sizeof(buffer)) == (int)sizeof(data)) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 5: a name past the stored length replaces the file holding its stored form
+    printf("Test 5 - Overlong target name: ");
+    char stored_name[MAX_FILENAME];
+    char long_name[MAX_FILENAME + 1];
+    memset(stored_name, 'a', MAX_FILENAME - 1);
+    stored_name[MAX_FILENAME - 1] = '\0';
+    memset(long_name, 'a', MAX_FILENAME);
+    long_name[MAX_FILENAME] = '\0';
+    fs_create(stored_name);
+    fs_write(stored_name, "old", 3);
+    fs_create("source.txt");
+    fs_write("source.txt", "new!", 4);
+    int renamed = fs_rename("source.txt", long_name);
+    char listed[MAX_FILES][MAX_FILENAME];
+    int listed_count = fs_list(listed, MAX_FILES);
+    int matches = 0;
+    for (int i = 0; i < listed_count; i++) {
+        if (strcmp(listed[i], stored_name) == 0) matches++;
+    }
+    if (renamed == 0 && matches == 1 && fs_read(stored_name, buffer, sizeof(buffer)) == 4 &&
+        memcmp(buffer, "new!", 4) == 0 && fs_rename(stored_name, long_name) == 0 && fs_exists(stored_name) == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - %d files named like the target\n", matches);
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
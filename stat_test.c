@@ -0,0 +1,92 @@
+// compile with: gcc -o stat_test stat_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_stat_disk.img"
+
+int main() {
+    char data[3 * BLOCK_SIZE];
+    fs_file_stat file_stat;
+
+    printf("=== Testing fs_stat and fs_exists ===\n");
+
+    // Test 1: not mounted
+    printf("Test 1 - Not mounted: ");
+    if (fs_exists("a.txt") == -3 && fs_stat("a.txt", &file_stat) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+
+    // Test 2: existence probes
+    printf("Test 2 - fs_exists: ");
+    fs_create("a.txt");
+    if (fs_exists("a.txt") == 1 && fs_exists("b.txt") == 0 && fs_exists("") == -3 &&
+        fs_stat("b.txt", &file_stat) == -1 && fs_stat("a.txt", NULL) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: size, blocks, layout and generation after a write
+    printf("Test 3 - Stat after write: ");
+    fs_stat("a.txt", &file_stat);
+    unsigned int created_generation = file_stat.generation;
+    memset(data, 'S', sizeof(data));
+    fs_write("a.txt", data, sizeof(data) - 10);
+    fs_stat("a.txt", &file_stat);
+    if (file_stat.size == (int)sizeof(data) - 10 && file_stat.blocks == 3 && file_stat.extents == 1 &&
+        file_stat.layout_flags == FS_LAYOUT_CONTIGUOUS && file_stat.generation != created_generation) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: holes and preallocation show up in the layout flags
+    printf("Test 4 - Holes and preallocation: ");
+    fs_truncate("a.txt", 5 * BLOCK_SIZE);
+    fs_stat("a.txt", &file_stat);
+    int has_holes = (file_stat.layout_flags & FS_LAYOUT_HAS_HOLES) && file_stat.blocks == 3;
+    fs_truncate("a.txt", BLOCK_SIZE);
+    fs_fallocate("a.txt", 4 * BLOCK_SIZE, FS_FALLOC_KEEP_SIZE);
+    fs_stat("a.txt", &file_stat);
+    if (has_holes && (file_stat.layout_flags & FS_LAYOUT_PREALLOCATED) && file_stat.blocks == 4 &&
+        file_stat.size == BLOCK_SIZE) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 5: staged writes report their pending size
+    printf("Test 5 - Staged write: ");
+    fs_set_write_policy(FS_POLICY_DELAYED_ALLOCATION);
+    fs_create("staged.txt");
+    fs_write("staged.txt", data, 100);
+    fs_stat("staged.txt", &file_stat);
+    fs_set_write_policy(FS_POLICY_IN_PLACE);
+    if (file_stat.size == 100 && file_stat.blocks == 0 && (file_stat.layout_flags & FS_LAYOUT_STAGED)) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
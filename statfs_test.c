@@ -0,0 +1,115 @@
+// compile with: gcc -o statfs_test statfs_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_statfs_disk.img"
+
+int main() {
+    char data[2 * BLOCK_SIZE];
+    fs_statfs_info info;
+    const int data_blocks = MAX_BLOCKS - 10;
+
+    printf("=== Testing fs_statfs ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+
+    // Test 1: fresh filesystem is one free extent
+    printf("Test 1 - Fresh filesystem: ");
+    if (fs_statfs(NULL) == -3 && fs_statfs(&info) == 0 && info.total_blocks == data_blocks &&
+        info.free_blocks == data_blocks && info.free_inodes == MAX_FILES && info.free_extents == 1 &&
+        info.largest_free_extent == data_blocks && info.fragmentation_percent == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: holes between files are counted as separate extents
+    printf("Test 2 - Fragmented free space: ");
+    memset(data, 'F', sizeof(data));
+    fs_create("one");
+    fs_create("two");
+    fs_create("three");
+    fs_write("one", data, sizeof(data));   // blocks 10-11
+    fs_write("two", data, sizeof(data));   // blocks 12-13
+    fs_write("three", data, sizeof(data)); // blocks 14-15
+    fs_delete("two");
+    fs_statfs(&info);
+    if (info.free_blocks == data_blocks - 4 && info.free_inodes == MAX_FILES - 2 &&
+        info.free_extents == 2 && info.largest_free_extent == data_blocks - 6 &&
+        info.fragmentation_percent == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - %d free, %d extents, largest %d\n", info.free_blocks, info.free_extents,
+               info.largest_free_extent);
+        return 1;
+    }
+
+    // Test 3: releasing the block between two free runs merges them
+    printf("Test 3 - Free extents merge: ");
+    fs_delete("one");
+    fs_statfs(&info);
+    if (info.free_extents == 2 && info.largest_free_extent == data_blocks - 6) {
+        fs_delete("three");
+        fs_statfs(&info);
+        if (info.free_extents == 1 && info.free_blocks == data_blocks) {
+            printf("PASSED\n");
+        } else {
+            printf("FAILED - did not merge\n");
+            return 1;
+        }
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: a stale superblock is corrected at mount
+    printf("Test 4 - Drifted superblock is recounted: ");
+    fs_create("kept");
+    fs_write("kept", data, sizeof(data));
+    fs_unmount();
+    int fd = open(TEST_DISK, O_RDWR);
+    superblock stale_superblock;
+    read(fd, &stale_superblock, sizeof(superblock));
+    stale_superblock.free_blocks = 7;
+    stale_superblock.free_inodes = 3;
+    lseek(fd, 0, SEEK_SET);
+    write(fd, &stale_superblock, sizeof(superblock));
+    close(fd);
+    fs_mount(TEST_DISK);
+    fs_statfs(&info);
+    if (info.free_blocks == data_blocks - 2 && info.free_inodes == MAX_FILES - 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 5: delayed writes show up as reservations
+    printf("Test 5 - Reservations: ");
+    fs_set_write_policy(FS_POLICY_DELAYED_ALLOCATION);
+    fs_create("staged");
+    fs_write("staged", data, sizeof(data));
+    fs_statfs(&info);
+    fs_set_write_policy(FS_POLICY_IN_PLACE);
+    if (info.reserved_blocks == 2 && info.available_blocks == info.free_blocks - 2) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
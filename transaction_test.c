@@ -0,0 +1,200 @@
+// compile with: gcc -o transaction_test transaction_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_transaction_disk.img"
+
+int main() {
+    char buffer[BLOCK_SIZE];
+    fs_statfs_info info;
+
+    printf("=== Testing transactions ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("old.txt");
+    fs_write("old.txt", "old", 3);
+    fs_create("keep.txt");
+    fs_write("keep.txt", "keep", 4);
+
+    // Test 1: argument validation
+    printf("Test 1 - Invalid parameters: ");
+    fs_transaction* txn = fs_transaction_begin();
+    if (txn != NULL && fs_transaction_write(NULL, "a", "x", 1) == -3 && fs_transaction_write(txn, "", "x", 1) == -3 &&
+        fs_transaction_write(txn, "a", "x", MAX_DIRECT_BLOCKS * BLOCK_SIZE + 1) == -2 &&
+        fs_transaction_delete(txn, NULL) == -3 && fs_transaction_commit(NULL) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+    fs_transaction_abort(txn);
+
+    // Test 2: nothing is visible before commit, everything after
+    printf("Test 2 - Commit applies the group: ");
+    txn = fs_transaction_begin();
+    fs_transaction_write(txn, "new.txt", "first", 5);
+    fs_transaction_write(txn, "keep.txt", "changed", 7);
+    fs_transaction_delete(txn, "old.txt");
+    fs_transaction_write(txn, "new.txt", "second", 6); // replaces the first write
+    int before_commit = fs_exists("new.txt") == 0 && fs_exists("old.txt") == 1;
+    memset(buffer, 0, sizeof(buffer));
+    if (before_commit && fs_transaction_commit(txn) == 0 && fs_exists("old.txt") == 0 &&
+        fs_read("new.txt", buffer, sizeof(buffer)) == 6 && memcmp(buffer, "second", 6) == 0 &&
+        fs_read("keep.txt", buffer, sizeof(buffer)) == 7 && memcmp(buffer, "changed", 7) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: a missing file fails the whole group before anything is applied
+    printf("Test 3 - Missing file rejects the group: ");
+    txn = fs_transaction_begin();
+    fs_transaction_write(txn, "never.txt", "x", 1);
+    fs_transaction_delete(txn, "missing.txt");
+    if (fs_transaction_commit(txn) == -1 && fs_exists("never.txt") == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: the group must fit as a whole
+    printf("Test 4 - Space checked up front: ");
+    fs_statfs(&info);
+    int files_needed = info.free_blocks / MAX_DIRECT_BLOCKS + 1;
+    static char big[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+    txn = fs_transaction_begin();
+    char name[32];
+    for (int i = 0; i < files_needed; i++) {
+        snprintf(name, sizeof(name), "big%d", i);
+        fs_transaction_write(txn, name, big, sizeof(big));
+    }
+    fs_statfs_info after;
+    if (fs_transaction_commit(txn) == -2 && fs_exists("big0") == 0 && fs_statfs(&after) == 0 &&
+        after.free_blocks == info.free_blocks) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 5: aborted operations never happen, committed ones survive remount
+    printf("Test 5 - Abort and durability: ");
+    txn = fs_transaction_begin();
+    fs_transaction_delete(txn, "keep.txt");
+    fs_transaction_abort(txn);
+    fs_unmount();
+    fs_mount(TEST_DISK);
+    if (fs_exists("keep.txt") == 1 && fs_read("new.txt", buffer, sizeof(buffer)) == 6) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 6: on a full disk, shrinking writes make room for growing ones
+    printf("Test 6 - Full disk, apply order: ");
+    static char pattern[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+    memset(pattern, 'A', sizeof(pattern));
+    fs_create("a.bin");
+    fs_write("a.bin", pattern, BLOCK_SIZE);
+    fs_create("b.bin");
+    fs_write("b.bin", pattern, 11 * BLOCK_SIZE);
+    fs_create("d.bin");
+    fs_write("d.bin", pattern, BLOCK_SIZE);
+    fs_statfs(&info);
+    for (int i = 0; info.free_blocks > 0; i++) {
+        int blocks = (info.free_blocks < MAX_DIRECT_BLOCKS) ? info.free_blocks : MAX_DIRECT_BLOCKS;
+        snprintf(name, sizeof(name), "fill%d", i);
+        fs_create(name);
+        fs_write(name, big, blocks * BLOCK_SIZE);
+        fs_statfs(&info);
+    }
+    txn = fs_transaction_begin();
+    fs_transaction_delete(txn, "d.bin");
+    fs_transaction_write(txn, "a.bin", pattern, sizeof(pattern));
+    fs_transaction_write(txn, "b.bin", "b", 1);
+    int committed = fs_transaction_commit(txn);
+    fs_file_stat a_stat, b_stat;
+    if (committed == 0 && fs_exists("d.bin") == 0 && fs_stat("a.bin", &a_stat) == 0 &&
+        a_stat.size == (int)sizeof(pattern) && fs_stat("b.bin", &b_stat) == 0 && b_stat.size == 1) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - commit returned %d\n", committed);
+        return 1;
+    }
+
+    // Test 7: an in-place rewrite keeps a preallocated tail, so it frees nothing for the group
+    printf("Test 7 - Preallocated tail is not counted as freed: ");
+    fs_unmount();
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("a.bin");
+    fs_write("a.bin", pattern, BLOCK_SIZE);
+    fs_fallocate("a.bin", MAX_DIRECT_BLOCKS * BLOCK_SIZE, FS_FALLOC_KEEP_SIZE);
+    fs_statfs(&info);
+    for (int i = 0; info.free_blocks > 5; i++) {
+        int blocks = (info.free_blocks - 5 < MAX_DIRECT_BLOCKS) ? info.free_blocks - 5 : MAX_DIRECT_BLOCKS;
+        snprintf(name, sizeof(name), "fill%d", i);
+        fs_create(name);
+        fs_write(name, big, blocks * BLOCK_SIZE);
+        fs_statfs(&info);
+    }
+    txn = fs_transaction_begin();
+    fs_transaction_write(txn, "b.bin", pattern, sizeof(pattern));
+    fs_transaction_write(txn, "a.bin", "a", 1);
+    committed = fs_transaction_commit(txn);
+    fs_statfs(&info);
+    if (committed == -2 && fs_exists("b.bin") == 0 && fs_stat("a.bin", &a_stat) == 0 && a_stat.size == BLOCK_SIZE &&
+        info.free_blocks == 5) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - commit returned %d\n", committed);
+        return 1;
+    }
+
+    // Test 8: under delayed allocation a shrink inside the group frees its blocks before a grow needs them
+    printf("Test 8 - Delayed allocation shrink makes room: ");
+    fs_unmount();
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("a.bin");
+    fs_write("a.bin", pattern, 10 * BLOCK_SIZE);
+    fs_statfs(&info);
+    for (int i = 0; info.free_blocks > 3; i++) {
+        int blocks = (info.free_blocks - 3 < MAX_DIRECT_BLOCKS) ? info.free_blocks - 3 : MAX_DIRECT_BLOCKS;
+        snprintf(name, sizeof(name), "fill%d", i);
+        fs_create(name);
+        fs_write(name, big, blocks * BLOCK_SIZE);
+        fs_statfs(&info);
+    }
+    fs_set_write_policy(FS_POLICY_DELAYED_ALLOCATION);
+    txn = fs_transaction_begin();
+    fs_transaction_write(txn, "a.bin", "a", 1);
+    fs_transaction_write(txn, "b.bin", pattern, sizeof(pattern));
+    committed = fs_transaction_commit(txn);
+    fs_statfs(&info);
+    if (committed == 0 && fs_stat("a.bin", &a_stat) == 0 && a_stat.size == 1 && fs_stat("b.bin", &b_stat) == 0 &&
+        b_stat.size == (int)sizeof(pattern) && info.free_blocks == 0 &&
+        fs_get_write_policy() == FS_POLICY_DELAYED_ALLOCATION) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED - commit returned %d\n", committed);
+        return 1;
+    }
+    fs_set_write_policy(FS_POLICY_IN_PLACE);
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
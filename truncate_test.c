@@ -0,0 +1,115 @@
+// compile with: gcc -o truncate_test truncate_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_truncate_disk.img"
+
+// Helper to count used data blocks in the on-disk bitmap
+int count_used_data_blocks_on_disk(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    unsigned char bitmap[BLOCK_SIZE];
+    lseek(fd, BLOCK_SIZE, SEEK_SET);
+    if (read(fd, bitmap, BLOCK_SIZE) != BLOCK_SIZE) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    int used = 0;
+    for (int block_index = 10; block_index < MAX_BLOCKS; block_index++) {
+        if (bitmap[block_index / 8] & (1 << (block_index % 8))) used++;
+    }
+    return used;
+}
+
+int main() {
+    char data[5 * BLOCK_SIZE];
+    char buffer[5 * BLOCK_SIZE];
+    char expected[5 * BLOCK_SIZE];
+    const int half_block = BLOCK_SIZE / 2;
+
+    printf("=== Testing fs_truncate ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("rotate.log");
+    memset(data, 'A', sizeof(data));
+    fs_write("rotate.log", data, sizeof(data));
+
+    // Test 1: invalid parameters
+    printf("Test 1 - Error codes: ");
+    if (fs_truncate("missing.log", 0) == -1 &&
+        fs_truncate("rotate.log", MAX_DIRECT_BLOCKS * BLOCK_SIZE + 1) == -2 &&
+        fs_truncate("rotate.log", -1) == -3 && fs_truncate(NULL, 0) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: shrinking frees the trailing blocks
+    printf("Test 2 - Shrink frees trailing blocks: ");
+    if (fs_truncate("rotate.log", BLOCK_SIZE + half_block) == 0 &&
+        count_used_data_blocks_on_disk(TEST_DISK) == 2 &&
+        fs_read("rotate.log", buffer, sizeof(buffer)) == BLOCK_SIZE + half_block &&
+        memcmp(buffer, data, BLOCK_SIZE + half_block) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: growing leaves a hole that reads as zeros, old tail bytes included
+    printf("Test 3 - Grow creates a zero-filled hole: ");
+    memset(expected, 0, sizeof(expected));
+    memset(expected, 'A', BLOCK_SIZE + half_block);
+    if (fs_truncate("rotate.log", 4 * BLOCK_SIZE) == 0 &&
+        count_used_data_blocks_on_disk(TEST_DISK) == 2 &&
+        fs_read("rotate.log", buffer, sizeof(buffer)) == 4 * BLOCK_SIZE &&
+        memcmp(buffer, expected, 4 * BLOCK_SIZE) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: writing over the hole allocates the missing blocks
+    printf("Test 4 - Write fills the hole: ");
+    memset(data, 'B', sizeof(data));
+    if (fs_write("rotate.log", data, sizeof(data)) == 0 &&
+        count_used_data_blocks_on_disk(TEST_DISK) == 5 &&
+        fs_read("rotate.log", buffer, sizeof(buffer)) == (int)sizeof(buffer) &&
+        memcmp(buffer, data, sizeof(data)) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 5: truncating to zero releases everything and survives remount
+    printf("Test 5 - Truncate to zero: ");
+    fs_truncate("rotate.log", 0);
+    fs_unmount();
+    fs_mount(TEST_DISK);
+    if (count_used_data_blocks_on_disk(TEST_DISK) == 0 && fs_read("rotate.log", buffer, sizeof(buffer)) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+// compile with: gcc -o write_stream_test write_stream_test.c fs.c -Wall -Wextra
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include "fs_ext.h"
+
+#define TEST_DISK "test_write_stream_disk.img"
+
+int main() {
+    static char expected[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+    static char buffer[MAX_DIRECT_BLOCKS * BLOCK_SIZE];
+    fs_write_stream* stream = NULL;
+    fs_statfs_info before, after;
+
+    printf("=== Testing streaming writes ===\n");
+
+    fs_format(TEST_DISK);
+    fs_mount(TEST_DISK);
+    fs_create("stream.bin");
+    fs_write("stream.bin", "old contents", 12);
+
+    // Test 1: open needs an existing file
+    printf("Test 1 - Open validation: ");
+    if (fs_write_stream_open("missing", &stream) == -1 && fs_write_stream_open("stream.bin", NULL) == -3 &&
+        fs_write_stream_close(NULL) == -3) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 2: odd-sized chunks, old contents visible until close
+    printf("Test 2 - Chunked write published on close: ");
+    for (int i = 0; i < (int)sizeof(expected); i++) {
+        expected[i] = (char)(i * 7 + 3);
+    }
+    int total = 3 * BLOCK_SIZE + 123;
+    fs_write_stream_open("stream.bin", &stream);
+    int offset = 0, chunk = 1;
+    while (offset < total) {
+        int this_chunk = (chunk < total - offset) ? chunk : total - offset;
+        fs_write_stream_write(stream, expected + offset, this_chunk);
+        offset += this_chunk;
+        chunk = chunk * 3 + 1;
+    }
+    int still_old = fs_read("stream.bin", buffer, sizeof(buffer)) == 12 && memcmp(buffer, "old contents", 12) == 0;
+    fs_file_stat st;
+    if (still_old && fs_write_stream_close(stream) == 0 && fs_read("stream.bin", buffer, sizeof(buffer)) == total &&
+        memcmp(buffer, expected, total) == 0 && fs_stat("stream.bin", &st) == 0 && st.blocks == 4) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 3: the size limit is enforced and abort gives every block back
+    printf("Test 3 - Size limit and abort: ");
+    fs_statfs(&before);
+    fs_write_stream_open("stream.bin", &stream);
+    int full = fs_write_stream_write(stream, expected, sizeof(expected));
+    int over = fs_write_stream_write(stream, "x", 1);
+    fs_write_stream_abort(stream);
+    fs_statfs(&after);
+    if (full == 0 && over == -2 && after.free_blocks == before.free_blocks &&
+        fs_read("stream.bin", buffer, sizeof(buffer)) == total) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    // Test 4: deleting the file under the stream, and unmounting with a stream open
+    printf("Test 4 - Delete and unmount under a stream: ");
+    fs_create("victim");
+    fs_write_stream_open("victim", &stream);
+    fs_write_stream_write(stream, expected, 2 * BLOCK_SIZE);
+    fs_delete("victim");
+    int deleted_result = fs_write_stream_close(stream);
+    fs_statfs(&before);
+    fs_write_stream_open("stream.bin", &stream);
+    fs_write_stream_write(stream, expected, 2 * BLOCK_SIZE + 1);
+    fs_unmount();
+    fs_mount(TEST_DISK);
+    fs_statfs(&after);
+    if (deleted_result == -1 && fs_write_stream_close(stream) == -3 && after.free_blocks == before.free_blocks &&
+        fs_read("stream.bin", buffer, sizeof(buffer)) == total && memcmp(buffer, expected, total) == 0) {
+        printf("PASSED\n");
+    } else {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    fs_unmount();
+
+    printf("\nAll tests passed!\n");
+
+    // Cleanup
+    unlink(TEST_DISK);
+
+    return 0;
+}